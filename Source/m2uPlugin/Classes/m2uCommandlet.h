@@ -0,0 +1,39 @@
+#pragma once
+#include "Commandlets/Commandlet.h"
+#include "m2uCommandlet.generated.h"
+
+
+/**
+   Build levels from m2u command files or scene packages without the UI, for
+   example on a build machine:
+
+   UE4Editor-Cmd.exe MyProject.uproject -run=m2u File=Level.m2u Map=/Game/Maps/MyMap Save
+
+   File  a batch file (see Fm2uBatchFileParser) or a scene package, if it
+         ends with .m2us (see Fm2uOpScenePackage)
+   Map   the map to load before executing the file, the current map otherwise
+   Save  save all packages that were changed
+   Report  write "Packages=<n> Actors=<n> Seconds=<s> Imported=<n>
+           ImportsFailed=<n>" to this file when done, the last two count
+           the entries of ImportAssetsBatch commands
+
+   There is no time budget, the file is executed as fast as possible.
+
+   UE4Editor-Cmd.exe MyProject.uproject -run=m2u -Server Port=3939 -nullrhi
+
+   Server   run the tcp server as a scene-assembly service for scripts, driven
+            by a tight loop instead of the editor frame tick. Runs until the
+            engine is asked to exit, for example with "Exec QUIT".
+   SleepMs  time to sleep in iterations that had nothing to do, 5 by
+            default. 0 only yields, that answers the first message after a
+            pause a bit faster but keeps a core busy while idle
+ */
+UCLASS()
+class Um2uCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet Interface
+};
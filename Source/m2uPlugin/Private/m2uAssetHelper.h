@@ -509,9 +509,10 @@ namespace m2uAssetHelper
 	}// ImportAssets()
 
 /**
-   Find an asset.
+   Get the full object path from an asset path as the Program sends them,
+   "/Game/Meshes/MyStaticMesh" becomes "/Game/Meshes/MyStaticMesh.MyStaticMesh"
  */
-	UObject* GetAssetFromPath(FString AssetPath)
+	FString GetObjectPathFromAssetPath(FString AssetPath)
 	{
 		// If there is no dot, add a dot and repeat the object name.
 		// /Game/Meshes/MyStaticMesh.MyStaticMesh would be the actual path
@@ -530,6 +531,15 @@ namespace m2uAssetHelper
 				AssetPath += ObjectName;
 			}
 		}
+		return AssetPath;
+	}
+
+/**
+   Find an asset.
+ */
+	UObject* GetAssetFromPath(FString AssetPath)
+	{
+		AssetPath = GetObjectPathFromAssetPath(AssetPath);
 
 
 		// try to find the asset
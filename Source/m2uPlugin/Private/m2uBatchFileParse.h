@@ -1,41 +1,325 @@
 #ifndef _M2UBATCHFILEPARSE_H_
 #define _M2UBATCHFILEPARSE_H_
 
+#include "m2uOperation.h"
+
 
 /**
-   this is a temporary solution to parse a file for commands that the m2u actions 
-   can execute. This will be integrated into m2u action classes once I find time
-   to refactor this all.
-   This function expects the import operations to be listed before the add operations
-   of course it will not perform intelligent checks if that is the case!
+   Executes a file of m2u commands, as the Program would send them over tcp.
+   The file is read in chunks and executed a bit every tick, so files of
+   hundreds of MB can be used to bootstrap whole levels without loading the
+   whole file into memory or blocking the editor.
+
+   File format:
+   Every line that doesn't start with whitespace starts a new command. Lines
+   starting with whitespace continue the previous command, they are appended
+   (trimmed) on a new line. This is how the batch commands get their lines:
+
+   AddObjectsToLayer
+     MyLayer [Actor1,Actor2]
+   TransformObject Actor1 T=(1 2 3)
+
+   Empty lines and lines starting with '#' are ignored.
+   The file is expected to be ANSI or UTF-8, a UTF-8 byte order mark is skipped.
+   Commands that no Operation knows are counted as failed and logged,
+   other results than "Ok" are logged verbose.
  */
-bool m2uBatchFileParse(FString& Filename)
+class Fm2uBatchFileParser
 {
-	FString Result;
-	if( FFileHelper::LoadFileToString(Result, *Filename) )
+public:
+
+Fm2uBatchFileParser( Fm2uOperationManager* InManager )
+	:Manager(InManager),
+	 FileHandle(NULL),
+	 FileSize(0),
+	 BytesRead(0),
+	 BytesConsumed(0),
+	 BufferPos(0),
+	 BufferEnd(0),
+	 NumCommands(0),
+	 NumFailed(0),
+	 TimeBudget(0.01),
+	 StartTime(0.0),
+	 LastReportTime(0.0)
+	{}
+
+	~Fm2uBatchFileParser()
+	{
+		Close();
+	}
+
+	/**
+	 * Start executing the file. A file that is currently running is cancelled.
+	 * Budget is the time in seconds that may be spent executing every tick,
+	 * 0 means run until the file is done (use for headless runs).
+	 */
+	bool Start( const FString& InFilename, double Budget = 0.01 )
+	{
+		if( IsRunning() )
+		{
+			Cancel();
+		}
+
+		FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*InFilename);
+		if( FileHandle == NULL )
+		{
+			UE_LOG(LogM2U, Error, TEXT("File \"%s\" not found."), *InFilename);
+			return false;
+		}
+		Filename = InFilename;
+		FileSize = FileHandle->Size();
+		BytesRead = BytesConsumed = 0;
+		BufferPos = BufferEnd = 0;
+		Buffer.SetNumUninitialized( ChunkSize );
+		PendingCommand.Empty();
+		NumCommands = NumFailed = 0;
+		TimeBudget = Budget;
+		StartTime = LastReportTime = FPlatformTime::Seconds();
+		UE_LOG(LogM2U, Log, TEXT("Parsing File \"%s\" (%lld bytes) for commands."), *Filename, FileSize);
+		return true;
+	}
+
+	/** stop executing the file, commands already executed are not reverted */
+	void Cancel()
+	{
+		if( IsRunning() )
+		{
+			UE_LOG(LogM2U, Warning, TEXT("Cancelled batch file \"%s\" after %d commands, %d failed (%s)."),
+				   *Filename, NumCommands, NumFailed, *GetStatus());
+			Close();
+		}
+	}
+
+	bool IsRunning() const
+	{
+		return FileHandle != NULL;
+	}
+
+	/** "<Filename> <Percent>% <Commands> commands <Failed> failed" or "Idle" */
+	FString GetStatus() const
+	{
+		if( ! IsRunning() )
+		{
+			return TEXT("Idle");
+		}
+		const float Percent = FileSize > 0 ? 100.0f * BytesConsumed / FileSize : 100.0f;
+		return FString::Printf(TEXT("%s %.1f%% %d commands %d failed"), *Filename, Percent, NumCommands, NumFailed);
+	}
+
+	/**
+	 * Execute commands until the time budget for this tick is used up.
+	 * The budget is checked after every command, a single command is never
+	 * split.
+	 */
+	void Tick( float DeltaTime )
+	{
+		if( ! IsRunning() )
+		{
+			return;
+		}
+
+		const double TickStart = FPlatformTime::Seconds();
+		const uint8* Line;
+		int32 LineLen;
+		while( true )
+		{
+			if( ! NextLine(Line, LineLen) )
+			{
+				// end of file, execute what's left
+				ExecutePending();
+				const double Seconds = FPlatformTime::Seconds() - StartTime;
+				UE_LOG(LogM2U, Log, TEXT("Finished batch file \"%s\": %d commands in %.2f seconds (%.0f commands/s), %d failed."),
+					   *Filename, NumCommands, Seconds, Seconds > 0.0 ? NumCommands / Seconds : 0.0, NumFailed);
+				Close();
+				return;
+			}
+
+			if( LineLen == 0 || Line[0] == '#' )
+			{
+				continue;
+			}
+
+			if( FChar::IsWhitespace(Line[0]) )
+			{
+				// continuation of the previous command
+				while( LineLen > 0 && FChar::IsWhitespace(*Line) )
+				{
+					++Line;
+					--LineLen;
+				}
+				if( LineLen > 0 && ! PendingCommand.IsEmpty() )
+				{
+					PendingCommand += TEXT("\n");
+					AppendLine( PendingCommand, Line, LineLen );
+				}
+				continue;
+			}
+
+			// a new command starts, so the previous is complete
+			const bool bDidExecute = ExecutePending();
+			AppendLine( PendingCommand, Line, LineLen );
+
+			if( bDidExecute && TimeBudget > 0.0 &&
+				FPlatformTime::Seconds() - TickStart >= TimeBudget )
+			{
+				break;
+			}
+		}
+
+		const double Now = FPlatformTime::Seconds();
+		if( Now - LastReportTime >= 2.0 )
+		{
+			LastReportTime = Now;
+			UE_LOG(LogM2U, Log, TEXT("Batch file progress: %s"), *GetStatus());
+		}
+	}
+
+protected:
+
+	/**
+	 * Get the next line (without line break) from the file, reading the next
+	 * chunk if required. The line points into the read buffer and is valid
+	 * until the next call.
+	 * Returns false at the end of the file.
+	 */
+	bool NextLine( const uint8*& OutLine, int32& OutLen )
 	{
-		UE_LOG(LogM2U, Error, TEXT("Batch File parsing is currently not implemented"));
-		return false;
-		UE_LOG(LogM2U, Error, TEXT("Parsing File \"%s\" for commands."), *Filename);
+		while( true )
+		{
+			const uint8* Start = Buffer.GetData() + BufferPos;
+			const int32 Available = BufferEnd - BufferPos;
+			const uint8* End = NULL;
+			for( const uint8* Char = Start; Char < Start + Available; ++Char )
+			{
+				if( *Char == '\n' )
+				{
+					End = Char;
+					break;
+				}
+			}
+			const bool bEof = BytesRead >= FileSize;
+			if( End != NULL || (bEof && Available > 0) )
+			{
+				const int32 Len = End != NULL ? End - Start : Available;
+				BufferPos += End != NULL ? Len + 1 : Len;
+				BytesConsumed = BytesRead - (BufferEnd - BufferPos);
+				OutLine = Start;
+				OutLen = (Len > 0 && Start[Len-1] == '\r') ? Len - 1 : Len;
+				return true;
+			}
+			if( bEof || ! ReadChunk() )
+			{
+				return false;
+			}
+		}
+	}
 
-		FString ImpCmd = TEXT("ImportAssetsBatch");
-		FString AddCmd = TEXT("AddActorBatch");
+	/**
+	 * Move the unconsumed rest to the front of the buffer and fill the rest
+	 * from the file. The buffer grows if a single line doesn't fit.
+	 */
+	bool ReadChunk()
+	{
+		const bool bFirstChunk = BytesRead == 0;
+		const int32 Rest = BufferEnd - BufferPos;
+		if( Rest > 0 && BufferPos > 0 )
+		{
+			FMemory::Memmove( Buffer.GetData(), Buffer.GetData() + BufferPos, Rest );
+		}
+		BufferPos = 0;
+		BufferEnd = Rest;
+		if( BufferEnd == Buffer.Num() )
+		{
+			Buffer.SetNumUninitialized( Buffer.Num() * 2 );
+		}
 
-		uint32 ImpStart = Result.Find(ImpCmd) + ImpCmd.Len();
-		uint32 AddStart = Result.Find(AddCmd);
-		uint32 ImpLength = AddStart - ImpStart;
+		const int64 ToRead = FMath::Min<int64>( Buffer.Num() - BufferEnd, FileSize - BytesRead );
+		if( ! FileHandle->Read( Buffer.GetData() + BufferEnd, ToRead ) )
+		{
+			UE_LOG(LogM2U, Error, TEXT("Reading \"%s\" failed."), *Filename);
+			return false;
+		}
+		BufferEnd += ToRead;
+		BytesRead += ToRead;
 
-		FString ImpBlock = Result.Mid(ImpStart, ImpLength);
-		FString AddBlock = Result.RightChop(AddStart + AddCmd.Len());
+		// skip the UTF-8 byte order mark, it would end up in the first command
+		if( bFirstChunk && BufferEnd >= 3 &&
+			Buffer[0] == 0xEF && Buffer[1] == 0xBB && Buffer[2] == 0xBF )
+		{
+			BufferPos = 3;
+		}
+		return true;
+	}
 
-		//m2uActions::ImportAssetsBatch(*ImpBlock);
-		//m2uActions::AddActorBatch(*AddBlock);
-		
+	static void AppendLine( FString& Str, const uint8* Line, int32 Len )
+	{
+		FUTF8ToTCHAR Converted( (const ANSICHAR*)Line, Len );
+		Str.AppendChars( Converted.Get(), Converted.Length() );
+	}
+
+	/** execute the collected command, if any. */
+	bool ExecutePending()
+	{
+		if( PendingCommand.IsEmpty() )
+		{
+			return false;
+		}
+		const FString Result = Manager->Execute( PendingCommand );
+		++NumCommands;
+		if( Result == TEXT("Command Not Found") )
+		{
+			++NumFailed;
+			UE_LOG(LogM2U, Warning, TEXT("Batch file \"%s\" command %d failed: %s"),
+				   *Filename, NumCommands, *CommandName());
+		}
+		else if( Result != TEXT("Ok") )
+		{
+			UE_LOG(LogM2U, Verbose, TEXT("Batch file \"%s\" command %d %s: %s"),
+				   *Filename, NumCommands, *CommandName(), *Result);
+		}
+		PendingCommand.Empty();
 		return true;
 	}
-	UE_LOG(LogM2U, Error, TEXT("File \"%s\" not found."), *Filename);
-	return false;
-}
+
+	/** the first line of the pending command, for logging */
+	FString CommandName() const
+	{
+		int32 LineEnd;
+		return PendingCommand.FindChar( TEXT('\n'), LineEnd ) ? PendingCommand.Left(LineEnd) : PendingCommand;
+	}
+
+	void Close()
+	{
+		delete FileHandle;
+		FileHandle = NULL;
+		Buffer.Empty();
+		PendingCommand.Empty();
+	}
+
+protected:
+
+	static const int32 ChunkSize = 4 * 1024 * 1024;
+
+	Fm2uOperationManager* Manager;
+	IFileHandle* FileHandle;
+	FString Filename;
+	int64 FileSize;
+	/** bytes read from the file into the buffer */
+	int64 BytesRead;
+	/** bytes of the file that were parsed into lines */
+	int64 BytesConsumed;
+	TArray<uint8> Buffer;
+	int32 BufferPos;
+	int32 BufferEnd;
+	/** the command that is collected from the lines until it is complete */
+	FString PendingCommand;
+	int32 NumCommands;
+	/** commands that no Operation could execute */
+	int32 NumFailed;
+	double TimeBudget;
+	double StartTime;
+	double LastReportTime;
+};
 
 
 
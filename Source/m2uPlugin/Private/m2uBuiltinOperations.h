@@ -11,6 +11,8 @@
 #include "m2uOpFetch.h"
 #include "m2uOpLayer.h"
 #include "m2uOpObject.h"
+#include "m2uOpProperty.h"
+#include "m2uOpScenePackage.h"
 #include "m2uOpSelection.h"
 #include "m2uOpTransaction.h"
 #include "m2uOpVisibility.h"
@@ -35,6 +37,11 @@ void CreateBuiltinOperations( Fm2uOperationManager* Manager )
 	new Fm2uOpObjectDuplicate(Manager);
 	new Fm2uOpObjectAdd(Manager);
 	new Fm2uOpObjectParent(Manager);
+	new Fm2uOpObjectAsset(Manager);
+
+	new Fm2uOpProperty(Manager);
+
+	new Fm2uOpScenePackage(Manager);
 
 	new Fm2uOpTransaction(Manager);
 
@@ -0,0 +1,180 @@
+
+#include "m2uPluginPrivatePCH.h"
+#include "m2uCommandlet.h"
+#include "UnrealEd.h"
+#include "EngineUtils.h"
+#include "FileHelpers.h"
+#include "Ticker.h"
+
+Um2uCommandlet::Um2uCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+static int32 CountLevelActors(UWorld* World)
+{
+	int32 Count = 0;
+	for( FActorIterator It(World); It; ++It )
+	{
+		++Count;
+	}
+	return Count;
+}
+
+
+/**
+ * Run the tcp server until the engine is asked to exit (Ctrl+C or "Exec QUIT").
+ * Instead of the editor frame tick, a tight loop drives the plugin, so
+ * nothing is rendered and every iteration handles the next message.
+ * The loop only sleeps when there was nothing to do, so a Program that sends
+ * commands back to back is never slowed down.
+ */
+static int32 RunServer(Fm2uPlugin& Plugin, const TMap<FString, FString>& ParamVals)
+{
+	uint16 Port = DEFAULT_M2U_PORT;
+	if( const FString* PortString = ParamVals.Find(TEXT("Port")) )
+	{
+		Port = FCString::Atoi(**PortString);
+	}
+	// time to give back to the system when idle, 0 only yields but keeps a
+	// core busy
+	float SleepMs = 5.0f;
+	if( const FString* SleepString = ParamVals.Find(TEXT("SleepMs")) )
+	{
+		SleepMs = FCString::Atof(**SleepString);
+	}
+
+	Plugin.ResetConnection(Port);
+	UE_LOG(LogM2U, Display, TEXT("m2u server running on port %i."), Port);
+
+	// checking for garbage has a cost of its own, don't do it every message
+	const double GCInterval = 1.0;
+	double LastTime = FPlatformTime::Seconds();
+	double LastGCTime = LastTime;
+	while( !GIsRequestingExit )
+	{
+		const double Now = FPlatformTime::Seconds();
+		const float DeltaTime = Now - LastTime;
+		LastTime = Now;
+
+		FTicker::GetCoreTicker().Tick(DeltaTime);
+		if( IsAsyncLoading() )
+		{
+			ProcessAsyncLoading(true, false, 0.005f);
+		}
+		const bool bHandledMessage = Plugin.Tick(DeltaTime);
+		// the editor would do this in its tick
+		if( Now - LastGCTime >= GCInterval )
+		{
+			GEngine->ConditionalCollectGarbage();
+			LastGCTime = Now;
+		}
+
+		if( !bHandledMessage && !Plugin.IsBusy() && !IsAsyncLoading() )
+		{
+			FPlatformProcess::Sleep(SleepMs / 1000.0f);
+		}
+	}
+
+	UE_LOG(LogM2U, Display, TEXT("m2u server stopped."));
+	return 0;
+}
+
+
+int32 Um2uCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	const bool bServer = Switches.Contains(TEXT("Server"));
+	const FString* File = ParamVals.Find(TEXT("File"));
+	if( File == NULL && !bServer )
+	{
+		UE_LOG(LogM2U, Error, TEXT("Usage: -run=m2u File=<batch file or .m2us package> [Map=<map>] [Save] [Report=<file>]"));
+		UE_LOG(LogM2U, Error, TEXT("       -run=m2u -Server [Port=3939] [SleepMs=5] [Map=<map>]"));
+		return 1;
+	}
+
+	const FString* Map = ParamVals.Find(TEXT("Map"));
+	if( Map != NULL && !FEditorFileUtils::LoadMap(*Map, false, false) )
+	{
+		UE_LOG(LogM2U, Error, TEXT("Could not load map %s."), **Map);
+		return 1;
+	}
+
+	Fm2uPlugin& Plugin = Fm2uPlugin::Get();
+	if( bServer )
+	{
+		return RunServer(Plugin, ParamVals);
+	}
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	const int32 ActorsBefore = CountLevelActors(World);
+	const double StartTime = FPlatformTime::Seconds();
+
+	// no budget, everything is done in as few ticks as possible
+	if( FPaths::GetExtension(*File) == TEXT("m2us") )
+	{
+		const FString Result = Plugin.ExecuteCommand( FString::Printf(TEXT("LoadScenePackage \"%s\" BudgetMs=0"), **File) );
+		if( Result != TEXT("Ok") )
+		{
+			UE_LOG(LogM2U, Error, TEXT("Loading %s failed: %s"), **File, *Result);
+			return 1;
+		}
+	}
+	else if( !Plugin.StartBatchFile(*File, 0.0) )
+	{
+		return 1;
+	}
+
+	double LastTime = StartTime;
+	while( Plugin.IsBusy() )
+	{
+		// the scene package waits for its assets
+		FlushAsyncLoading();
+		const double Now = FPlatformTime::Seconds();
+		Plugin.Tick( Now - LastTime );
+		LastTime = Now;
+	}
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+	const int32 NumNewActors = CountLevelActors(World) - ActorsBefore;
+	UE_LOG(LogM2U, Display, TEXT("Executed %s in %.2f seconds, %i new actors (%.0f actors/s)."),
+		   **File, Seconds, NumNewActors, Seconds > 0.0 ? NumNewActors / Seconds : 0.0);
+
+	int32 NumSaved = 0;
+	if( Switches.Contains(TEXT("Save")) )
+	{
+		const double SaveStart = FPlatformTime::Seconds();
+		TArray<UPackage*> DirtyPackages;
+		FEditorFileUtils::GetDirtyWorldPackages(DirtyPackages);
+		FEditorFileUtils::GetDirtyContentPackages(DirtyPackages);
+		if( !FEditorFileUtils::SaveDirtyPackages(false, true, true) )
+		{
+			UE_LOG(LogM2U, Error, TEXT("Saving the packages failed."));
+			return 1;
+		}
+		NumSaved = DirtyPackages.Num();
+		UE_LOG(LogM2U, Display, TEXT("Saved %i packages in %.2f seconds."), NumSaved, FPlatformTime::Seconds() - SaveStart);
+	}
+
+	// for whoever started us, see Fm2uOpAssetImport::ImportAssetsSharded
+	if( const FString* Report = ParamVals.Find(TEXT("Report")) )
+	{
+		const FString ImportStats = Plugin.ExecuteCommand(TEXT("GetImportStats"));
+		const FString Text = FString::Printf(TEXT("Packages=%i Actors=%i Seconds=%.2f %s\n"),
+											 NumSaved, NumNewActors, FPlatformTime::Seconds() - StartTime, *ImportStats);
+		if( !FFileHelper::SaveStringToFile(Text, **Report) )
+		{
+			UE_LOG(LogM2U, Error, TEXT("Could not write the report %s."), **Report);
+			return 1;
+		}
+	}
+	return 0;
+}
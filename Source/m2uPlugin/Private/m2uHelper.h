@@ -9,6 +9,7 @@
 #include "AssetSelection.h"
 #include "m2uAssetHelper.h"
 #include "Runtime/Launch/Resources/Version.h"
+#include "Base64.h"
 
 // Functions I'm currently using from this cpp file aren't exported, so they will
 // be unresolved symbols on Windows. For now importing the cpp is OK...
@@ -37,8 +38,114 @@ namespace m2uHelper
 		return Result;
 	}
 
+/**
+   Compact handles for Actors.
+   The Program may refer to an Actor by "#<Handle>" instead of its name in any
+   command. A handle is an index into this table, so resolving it does not need
+   any string parsing or object search, and it stays valid when the Actor is
+   renamed. Handles are never reused during a session, the handle of a deleted
+   Actor just doesn't resolve anymore.
+ */
+	struct Fm2uActorHandleTable
+	{
+		TArray< TWeakObjectPtr<AActor> > Actors;
+		TMap< TWeakObjectPtr<AActor>, int32 > Handles;
+
+		static Fm2uActorHandleTable& Get()
+		{
+			static Fm2uActorHandleTable Table;
+			return Table;
+		}
+
+		Fm2uActorHandleTable()
+		{
+			if( GEngine != NULL )
+			{
+				GEngine->OnLevelActorDeleted().AddRaw(this, &Fm2uActorHandleTable::Forget);
+			}
+		}
+
+		/** drop the entry of a deleted Actor, the handle stays unused */
+		void Forget(AActor* Actor)
+		{
+			int32 Handle;
+			if( Handles.RemoveAndCopyValue(TWeakObjectPtr<AActor>(Actor), Handle) )
+			{
+				Actors[Handle].Reset();
+			}
+		}
+	};
+
+/**
+   get the handle of the Actor, a new one is created if it has none yet.
+ */
+	int32 GetActorHandle(AActor* Actor)
+	{
+		Fm2uActorHandleTable& Table = Fm2uActorHandleTable::Get();
+		const TWeakObjectPtr<AActor> Key(Actor);
+		const int32* Existing = Table.Handles.Find(Key);
+		if( Existing != NULL )
+		{
+			return *Existing;
+		}
+		const int32 Handle = Table.Actors.Add(Key);
+		Table.Handles.Add(Key, Handle);
+		return Handle;
+	}
+
+/**
+   get the handle of the Actor in the form the Program uses "#<Handle>".
+ */
+	FString GetActorHandleString(AActor* Actor)
+	{
+		return FString::Printf(TEXT("#%i"), GetActorHandle(Actor));
+	}
+
+/**
+   resolve a handle, returns NULL if the handle is unknown or the Actor is gone.
+ */
+	AActor* GetActorByHandle(int32 Handle)
+	{
+		Fm2uActorHandleTable& Table = Fm2uActorHandleTable::Get();
+		if( !Table.Actors.IsValidIndex(Handle) )
+		{
+			return NULL;
+		}
+		AActor* Actor = Table.Actors[Handle].Get();
+		if( Actor == NULL && Table.Actors[Handle].IsStale() )
+		{
+			// destroyed without being deleted from the level (level unloaded)
+			Table.Handles.Remove(Table.Actors[Handle]);
+			Table.Actors[Handle].Reset();
+		}
+		return Actor;
+	}
+
+/**
+   parse the number of a handle string "#<Handle>", without the "#".
+   Returns false if it is not a number.
+ */
+	bool ParseActorHandle(const TCHAR* Str, int32& OutHandle)
+	{
+		if( *Str == 0 )
+		{
+			return false;
+		}
+		for( const TCHAR* Char = Str; *Char; ++Char )
+		{
+			if( !FChar::IsDigit(*Char) )
+			{
+				return false;
+			}
+		}
+		OutHandle = FCString::Atoi(Str);
+		return true;
+	}
+
+
 /**
    tries to find an Actor by name and makes sure it is valid.
+   The name may also be a handle in the form "#<Handle>", see GetActorHandle.
    @param Name The name to look for
    @param OutActor This will be the found Actor or NULL
    @param InWorld The world in which to search for the Actor
@@ -53,7 +160,19 @@ bool GetActorByName( const TCHAR* Name, AActor** OutActor, UWorld* InWorld = NUL
 		InWorld = GEditor->GetEditorWorldContext().World();
 	}
 	AActor* Actor;
-	Actor = FindObject<AActor>( InWorld->GetCurrentLevel(), Name, false );
+	if( Name[0] == TCHAR('#') )
+	{
+		int32 Handle;
+		if( !ParseActorHandle(Name + 1, Handle) )
+		{
+			return false;
+		}
+		Actor = GetActorByHandle( Handle );
+	}
+	else
+	{
+		Actor = FindObject<AActor>( InWorld->GetCurrentLevel(), Name, false );
+	}
 	//Actor = FindObject<AActor>( ANY_PACKAGE, Name, false );
 	// TODO: check if StaticFindObject or StaticFindObjectFastInternal is better
 	// and if searching in current world gives a perfo boost, if thats possible
@@ -75,6 +194,100 @@ bool GetActorByName( const TCHAR* Name, AActor** OutActor, UWorld* InWorld = NUL
 }
 
 
+/**
+ * FString SanitizeObjectName(const FString& Name)
+ *
+ * Remove all INVALID_OBJECTNAME_CHARACTERS from the Name.
+ * Instead of searching the string once for every invalid character, a lookup
+ * table is built once and the string is copied in a single pass.
+ */
+	FString SanitizeObjectName(const FString& Name)
+	{
+		struct FInvalidTable
+		{
+			bool bInvalid[256];
+			FInvalidTable()
+			{
+				FMemory::Memzero(bInvalid, sizeof(bInvalid));
+				for( const TCHAR* Char = INVALID_OBJECTNAME_CHARACTERS; *Char; ++Char )
+				{
+					if( (uint32)*Char < 256 )
+						bInvalid[ (uint32)*Char ] = true;
+				}
+			}
+		};
+		static const FInvalidTable Table;
+
+		FString Result;
+		Result.Reserve(Name.Len());
+		for( const TCHAR Char : Name.GetCharArray() )
+		{
+			if( Char == 0 )
+				break;
+			if( (uint32)Char < 256 && Table.bInvalid[ (uint32)Char ] )
+				continue;
+			Result.AppendChar(Char);
+		}
+		return Result;
+	}
+
+
+/**
+ * bool GetSanitizedFName(const FString& Name, FName& OutName)
+ *
+ * Get the FName for the sanitized Name string (see SanitizeObjectName).
+ * Returns false if nothing is left after sanitizing. Note that OutName may
+ * still be NAME_None for a literal "None".
+ *
+ * The Program sends the same names over and over (add, rename, duplicate, ...)
+ * so the results are cached for the session, to not sanitize and look up the
+ * FName of a string more than once. The cache is cleared when it gets too big.
+ * Maya names are case-sensitive, so the cache is too, otherwise "chair" would
+ * get the FName of an earlier "Chair".
+ */
+	struct FSanitizedName
+	{
+		FName Name;
+		bool bEmpty;
+	};
+
+	struct FCaseSensitiveNameKeyFuncs : BaseKeyFuncs<TPair<FString, FSanitizedName>, FString, false>
+	{
+		static const FString& GetSetKey(const TPair<FString, FSanitizedName>& Element)
+		{
+			return Element.Key;
+		}
+		static bool Matches(const FString& A, const FString& B)
+		{
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+		static uint32 GetKeyHash(const FString& Key)
+		{
+			return FCrc::StrCrc32(*Key);
+		}
+	};
+
+	bool GetSanitizedFName(const FString& Name, FName& OutName)
+	{
+		static TMap<FString, FSanitizedName, FDefaultSetAllocator, FCaseSensitiveNameKeyFuncs> Cache;
+		const FSanitizedName* Cached = Cache.Find(Name);
+		if( Cached == NULL )
+		{
+			if( Cache.Num() >= 65536 )
+			{
+				Cache.Empty();
+			}
+			const FString GeneratedName = SanitizeObjectName(Name);
+			FSanitizedName Entry;
+			Entry.bEmpty = GeneratedName.IsEmpty();
+			Entry.Name = Entry.bEmpty ? NAME_None : FName(*GeneratedName);
+			Cached = &Cache.Add(Name, Entry);
+		}
+		OutName = Cached->Name;
+		return !Cached->bEmpty;
+	}
+
+
 /**
  * FName GetFreeName(const FString& Name)
  *
@@ -87,20 +300,8 @@ bool GetActorByName( const TCHAR* Name, AActor** OutActor, UWorld* InWorld = NUL
 	FName GetFreeName(const FString& Name)
 	{
 		// Generate a valid FName from the String
-
-		FString GeneratedName = Name;
-		// create valid object name from the string. (remove invalid characters)
-		for( int32 BadCharacterIndex = 0; BadCharacterIndex < ARRAY_COUNT(
-				 INVALID_OBJECTNAME_CHARACTERS ) - 1; ++BadCharacterIndex )
-		{
-			const TCHAR TestChar[2] = { INVALID_OBJECTNAME_CHARACTERS[
-					BadCharacterIndex ], 0 };
-			const int32 NumReplacedChars = GeneratedName.ReplaceInline( TestChar,
-																		TEXT( "" ) );
-		}
-
-		FName TestName( *GeneratedName );
-		if( TestName == NAME_None )
+		FName TestName;
+		if( !GetSanitizedFName( Name, TestName ) || TestName == NAME_None )
 		{
 			TestName = FName( *M2U_GENERATED_NAME );
 		}
@@ -136,66 +337,580 @@ bool GetActorByName( const TCHAR* Name, AActor** OutActor, UWorld* InWorld = NUL
 
 	
 /**
- * void SetActorTransformRelativeFromText(AActor* Actor, const TCHAR* Stream)
+ * ComponentType* FindActorComponent<ComponentType>(AActor* Actor)
  *
- * Set the Actors relative transformations to the values provided in text-form
- * T=(x y z) R=(x y z) S=(x y z)
- * If one or more of T, R or S is not present in the String, they will be ignored.
+ * Get the Actor's root component if it is of the desired type, or the first
+ * component of that type otherwise.
+ */
+	template< class ComponentType >
+	ComponentType* FindActorComponent(AActor* Actor)
+	{
+		ComponentType* Component = Cast<ComponentType>(Actor->GetRootComponent());
+		if( Component == NULL )
+		{
+			Component = Actor->FindComponentByClass<ComponentType>();
+		}
+		return Component;
+	}
+
+
+/**
+ * bool SetActorAsset(AActor* Actor, UObject* Asset)
  *
- * Relative transformations are the actual transformation values you see in the 
- * Editor. They are equivalent to object-space transforms in maya for example.
+ * Swap the asset used by the Actor's component in place. The type of the Asset
+ * decides which component is edited, so for a StaticMesh this will be the first
+ * StaticMeshComponent of the Actor and so on.
+ * This is a lot cheaper than deleting and re-adding the Actor and all other
+ * properties of the Actor are kept.
  *
- * Setting world-space transforms using SetActorLocation or so will yield fucked
- * up results when using nested transforms (parenting actors).
+ * @return false if the Actor has no component that can use the Asset
+ */
+	bool SetActorAsset(AActor* Actor, UObject* Asset)
+	{
+		if( UStaticMesh* StaticMesh = Cast<UStaticMesh>(Asset) )
+		{
+			UStaticMeshComponent* Component = FindActorComponent<UStaticMeshComponent>(Actor);
+			if( Component == NULL )
+				return false;
+			if( Component->StaticMesh != StaticMesh )
+			{
+				// set the property directly (like the details panel does) because
+				// SetStaticMesh refuses to change static components. The edit
+				// change calls reregister the component and let it update what
+				// depends on the mesh, like override materials.
+				UProperty* MeshProperty = FindField<UProperty>( UStaticMeshComponent::StaticClass(),
+					GET_MEMBER_NAME_CHECKED(UStaticMeshComponent, StaticMesh) );
+				Component->Modify();
+				Component->PreEditChange(MeshProperty);
+				Component->StaticMesh = StaticMesh;
+				FPropertyChangedEvent PropertyChangedEvent(MeshProperty);
+				Component->PostEditChangeProperty(PropertyChangedEvent);
+			}
+		}
+		else if( USkeletalMesh* SkeletalMesh = Cast<USkeletalMesh>(Asset) )
+		{
+			USkeletalMeshComponent* Component = FindActorComponent<USkeletalMeshComponent>(Actor);
+			if( Component == NULL )
+				return false;
+			if( Component->SkeletalMesh != SkeletalMesh )
+			{
+				Component->Modify();
+				Component->SetSkeletalMesh(SkeletalMesh);
+			}
+		}
+		else if( UParticleSystem* ParticleSystem = Cast<UParticleSystem>(Asset) )
+		{
+			UParticleSystemComponent* Component = FindActorComponent<UParticleSystemComponent>(Actor);
+			if( Component == NULL )
+				return false;
+			if( Component->Template != ParticleSystem )
+			{
+				Component->Modify();
+				Component->SetTemplate(ParticleSystem);
+			}
+		}
+		else
+		{
+			UE_LOG(LogM2U, Log, TEXT("Can't set asset %s on %s, unsupported asset type."),
+				   *Asset->GetName(), *Actor->GetName());
+			return false;
+		}
+
+		Actor->MarkPackageDirty();
+		return true;
+	}// bool SetActorAsset()
+
+
+/**
+ * const TCHAR* GetFloatsSpaceDelimited(const TCHAR* Stream, float* Values, int32 Count)
  *
- * The Actor has to be valid, so check before calling this function!
+ * Read Count space-delimited float values from the Stream, works like the
+ * GetFVECTORSpaceDelimited function from the ParamParser.
+ *
+ * @return The Stream positioned at the last read value or NULL if there were
+ *         not enough values in the Stream.
  */
-	void SetActorTransformRelativeFromText(AActor* Actor, const TCHAR* Str)
+	const TCHAR* GetFloatsSpaceDelimited(const TCHAR* Stream, float* Values, int32 Count)
+	{
+		for( int32 Idx = 0; Idx < Count && Stream != NULL; ++Idx )
+		{
+			if( Idx > 0 )
+			{
+				Stream = FCString::Strchr(Stream,' ');
+				if( Stream == NULL )
+					break;
+				++Stream;
+			}
+			Values[Idx] = FCString::Atof(Stream);
+		}
+		return Stream;
+	}
+
+/**
+ * The content of a transform message.
+ * Every part is optional, parts that are not present in the message will not be
+ * touched when the transform is applied to an Actor.
+ * A rotation may be provided as Euler angles (Rotator) or as a Quaternion, a
+ * matrix will be decomposed into location, quaternion and scale when parsed.
+ */
+	struct Fm2uTransformInput
+	{
+		bool bHasLocation;
+		bool bHasRotator;
+		bool bHasQuat;
+		bool bHasScale;
+		bool bWorldSpace;
+
+		FVector Location;
+		FRotator Rotator;
+		FQuat Quat;
+		FVector Scale;
+
+		Fm2uTransformInput()
+			:bHasLocation(false), bHasRotator(false), bHasQuat(false),
+			 bHasScale(false), bWorldSpace(false),
+			 Location(FVector::ZeroVector), Rotator(FRotator::ZeroRotator),
+			 Quat(FQuat::Identity), Scale(FVector(1.0f))
+		{}
+
+		/** set all parts from a complete transform */
+		void SetFromTransform(const FTransform& Transform)
+		{
+			bHasLocation = bHasQuat = bHasScale = true;
+			bHasRotator = false;
+			Location = Transform.GetLocation();
+			Quat = Transform.GetRotation();
+			Scale = Transform.GetScale3D();
+		}
+	};
+
+
+/**
+ * void ParseTransformFromText(const TCHAR* Str, Fm2uTransformInput& OutInput)
+ *
+ * Parse transformation values provided in text-form
+ * T=(x y z) R=(x y z) S=(x y z)
+ * The rotation may alternatively be given as a quaternion with Q=(x y z w).
+ * A full matrix may be given with M=(m00 m01 m02 m03 m10 ... m33), the values
+ * are expected row by row with the translation in the fourth row, as in FMatrix.
+ * A matrix overrides all other values.
+ * With World=True, the values are world-space transforms.
+ */
+	void ParseTransformFromText(const TCHAR* Str, Fm2uTransformInput& OutInput)
 	{
 		const TCHAR* Stream; // used for searching in Str
-		//if( Stream != NULL )
-		//{	++Stream;  } // skip a space
+
+		FParse::Bool(Str, TEXT("World="), OutInput.bWorldSpace);
+
+		// get a full matrix
+		if( (Stream =  FCString::Strfind(Str,TEXT("M="))) )
+		{
+			Stream += 3; // skip "M=("
+			FMatrix Matrix;
+			if( GetFloatsSpaceDelimited( Stream, &Matrix.M[0][0], 16 ) )
+			{
+				OutInput.SetFromTransform( FTransform(Matrix) );
+				return;
+			}
+		}
 
 		// get location
-		FVector Loc;
 		if( (Stream =  FCString::Strfind(Str,TEXT("T="))) )
 		{
 			Stream += 3; // skip "T=("
-			Stream = GetFVECTORSpaceDelimited( Stream, Loc );
-			//UE_LOG(LogM2U, Log, TEXT("Loc %s"), *(Loc.ToString()) );
-			Actor->SetActorRelativeLocation( Loc, false );
+			Stream = GetFVECTORSpaceDelimited( Stream, OutInput.Location );
+			OutInput.bHasLocation = true;
 		}
 
-		// get rotation
-		FRotator Rot;
-		if( (Stream =  FCString::Strfind(Str,TEXT("R="))) )
+		// get rotation, prefer the quaternion if both are present
+		if( (Stream =  FCString::Strfind(Str,TEXT("Q="))) )
+		{
+			Stream += 3; // skip "Q=("
+			float Values[4];
+			if( GetFloatsSpaceDelimited( Stream, Values, 4 ) )
+			{
+				OutInput.Quat = FQuat(Values[0], Values[1], Values[2], Values[3]);
+				OutInput.Quat.Normalize();
+				OutInput.bHasQuat = true;
+			}
+		}
+		else if( (Stream =  FCString::Strfind(Str,TEXT("R="))) )
 		{
 			Stream += 3; // skip "R=("
-			Stream = GetFROTATORSpaceDelimited( Stream, Rot, 1.0f );
-			//UE_LOG(LogM2U, Log, TEXT("Rot %s"), *(Rot.ToString()) );
-			Actor->SetActorRelativeRotation( Rot, false );
+			Stream = GetFROTATORSpaceDelimited( Stream, OutInput.Rotator, 1.0f );
+			OutInput.bHasRotator = true;
 		}
 
 		// get scale
-		FVector Scale;
 		if( (Stream =  FCString::Strfind(Str,TEXT("S="))) )
 		{
 			Stream += 3; // skip "S=("
-			Stream = GetFVECTORSpaceDelimited( Stream, Scale );
-			//UE_LOG(LogM2U, Log, TEXT("Scc %s"), *(Scale.ToString()) );
-			Actor->SetActorRelativeScale3D( Scale );
+			Stream = GetFVECTORSpaceDelimited( Stream, OutInput.Scale );
+			OutInput.bHasScale = true;
 		}
+	}// void ParseTransformFromText()
 
+
+/**
+ * void FinishActorTransformEdit(AActor* Actor)
+ *
+ * Tell the Actor and the Editor that the Actor was moved.
+ */
+	void FinishActorTransformEdit(AActor* Actor)
+	{
 		Actor->InvalidateLightingCache();
 		// Call PostEditMove to update components, etc.
 		Actor->PostEditMove( true );
 		Actor->CheckDefaultSubobjects();
 		// Request saves/refreshes.
 		Actor->MarkPackageDirty();
+	}
+
 
+/**
+ * void SetActorTransform(AActor* Actor, const Fm2uTransformInput& Input)
+ *
+ * Apply the transform values to the Actor's root component.
+ * A complete transform is set in one go, so the component and its children only
+ * update once. A rotator is set as is, so the Euler values seen in the Editor
+ * will be exactly what was provided.
+ *
+ * The Actor has to be valid, so check before calling this function!
+ */
+	void SetActorTransform(AActor* Actor, const Fm2uTransformInput& Input)
+	{
+		USceneComponent* Root = Actor->GetRootComponent();
+		if( Root == NULL )
+		{
+			return;
+		}
+		// record for undo, if there is a transaction going on
+		Actor->Modify();
+		Root->Modify();
+
+		const bool bComplete = Input.bHasLocation && Input.bHasQuat && Input.bHasScale;
+		if( Input.bWorldSpace )
+		{
+			if( bComplete )
+			{
+				Root->SetWorldTransform( FTransform(Input.Quat, Input.Location, Input.Scale) );
+			}
+			else
+			{
+				if( Input.bHasLocation )
+					Root->SetWorldLocation( Input.Location );
+				if( Input.bHasQuat )
+					Root->SetWorldRotation( Input.Quat );
+				else if( Input.bHasRotator )
+					Root->SetWorldRotation( Input.Rotator );
+				if( Input.bHasScale )
+					Root->SetWorldScale3D( Input.Scale );
+			}
+		}
+		else
+		{
+			if( bComplete )
+			{
+				Root->SetRelativeTransform( FTransform(Input.Quat, Input.Location, Input.Scale) );
+			}
+			else
+			{
+				if( Input.bHasLocation )
+					Root->SetRelativeLocation( Input.Location );
+				if( Input.bHasQuat )
+					Root->SetRelativeRotation( Input.Quat );
+				else if( Input.bHasRotator )
+					Root->SetRelativeRotation( Input.Rotator );
+				if( Input.bHasScale )
+					Root->SetRelativeScale3D( Input.Scale );
+			}
+		}
+
+		FinishActorTransformEdit(Actor);
+	}// void SetActorTransform()
+
+
+/**
+ * void SetActorTransformRelativeFromText(AActor* Actor, const TCHAR* Stream)
+ *
+ * Set the Actors relative transformations to the values provided in text-form
+ * T=(x y z) R=(x y z) S=(x y z)
+ * If one or more of T, R or S is not present in the String, they will be ignored.
+ * See ParseTransformFromText for the quaternion and matrix forms.
+ *
+ * Relative transformations are the actual transformation values you see in the 
+ * Editor. They are equivalent to object-space transforms in maya for example.
+ *
+ * Setting world-space transforms using SetActorLocation or so will yield fucked
+ * up results when using nested transforms (parenting actors).
+ *
+ * The Actor has to be valid, so check before calling this function!
+ */
+	void SetActorTransformRelativeFromText(AActor* Actor, const TCHAR* Str)
+	{
+		Fm2uTransformInput Input;
+		ParseTransformFromText(Str, Input);
+		Input.bWorldSpace = false;
+		SetActorTransform(Actor, Input);
 	}// void SetActorTransformRelativeFromText()
 
 
+/**
+ * void SetActorTransformWorldFromText(AActor* Actor, const TCHAR* Stream)
+ *
+ * Same as SetActorTransformRelativeFromText, but the values are world-space.
+ * Use this when the Program has the world matrix at hand anyway, so it does not
+ * have to compute the local transform first.
+ */
+	void SetActorTransformWorldFromText(AActor* Actor, const TCHAR* Str)
+	{
+		Fm2uTransformInput Input;
+		ParseTransformFromText(Str, Input);
+		Input.bWorldSpace = true;
+		SetActorTransform(Actor, Input);
+	}// void SetActorTransformWorldFromText()
+
+
+/**
+ * void SetActorTransformsBatch(const TArray<AActor*>& Actors, const TArray<Fm2uTransformInput>& Inputs)
+ *
+ * Apply the transform Inputs to the Actors (same index), while updating every
+ * moved hierarchy only once.
+ *
+ * Setting the transform of an Actor propagates the change to all its attached
+ * children. When a parent and its children are in the same batch, setting them
+ * one by one would recompute the children's world transforms for every moved
+ * ancestor. So instead we:
+ * 1. sort the Actors by attachment depth, so parents are handled before children
+ * 2. compute the new relative transform of every Actor, world-space inputs are
+ *    resolved against the *new* world transform of a parent in the batch,
+ *    and write it to the root component without updating anything
+ * 3. update the component-to-world of the topmost moved component of every
+ *    subtree, which propagates down to all children once
+ */
+	void SetActorTransformsBatch(const TArray<AActor*>& Actors, const TArray<Fm2uTransformInput>& Inputs)
+	{
+		check( Actors.Num() == Inputs.Num() );
+
+		// index of the entry for every root component in the batch
+		TMap<USceneComponent*, int32> BatchIndex;
+		for( int32 Idx = 0; Idx < Actors.Num(); ++Idx )
+		{
+			if( Actors[Idx] != NULL && Actors[Idx]->GetRootComponent() != NULL )
+			{
+				BatchIndex.Add(Actors[Idx]->GetRootComponent(), Idx);
+			}
+		}
+
+		// find the attachment depth for every entry, memorized for all visited
+		// components, so every hierarchy is walked only once
+		TMap<USceneComponent*, int32> Depths;
+		TArray<int32> Order;
+		TArray<int32> EntryDepth;
+		EntryDepth.SetNumZeroed(Actors.Num());
+		for( auto It = BatchIndex.CreateConstIterator(); It; ++It )
+		{
+			TArray<USceneComponent*> Chain;
+			USceneComponent* Component = It.Key();
+			int32 Depth = -1;
+			while( Component != NULL )
+			{
+				const int32* Known = Depths.Find(Component);
+				if( Known != NULL )
+				{
+					Depth = *Known;
+					break;
+				}
+				Chain.Push(Component);
+				Component = Component->GetAttachParent();
+			}
+			while( Chain.Num() > 0 )
+			{
+				Depths.Add(Chain.Pop(), ++Depth);
+			}
+			EntryDepth[It.Value()] = Depths.FindChecked(It.Key());
+			Order.Add(It.Value());
+		}
+		Order.Sort( [&EntryDepth](const int32& A, const int32& B)
+					{ return EntryDepth[A] < EntryDepth[B]; } );
+
+		// the new world transforms of the root components in the batch
+		TMap<USceneComponent*, FTransform> NewWorld;
+		// the roots of the moved subtrees, need the final update
+		TArray<USceneComponent*> SubtreeRoots;
+
+		for( int32 Idx : Order )
+		{
+			USceneComponent* Root = Actors[Idx]->GetRootComponent();
+			const Fm2uTransformInput& Input = Inputs[Idx];
+
+			// world transform of what we are attached to, after the batch
+			FTransform ParentWorld = FTransform::Identity;
+			bool bParentMoved = false;
+			USceneComponent* Parent = Root->GetAttachParent();
+			if( Parent != NULL )
+			{
+				ParentWorld = Parent->GetSocketTransform(Root->AttachSocketName);
+				// find the closest ancestor in the batch, its new transform
+				// also moves our parent
+				for( USceneComponent* Ancestor = Parent; Ancestor != NULL;
+					 Ancestor = Ancestor->GetAttachParent() )
+				{
+					const FTransform* AncestorNew = NewWorld.Find(Ancestor);
+					if( AncestorNew != NULL )
+					{
+						const FTransform InAncestor =
+							ParentWorld.GetRelativeTransform(Ancestor->ComponentToWorld);
+						ParentWorld = InAncestor * (*AncestorNew);
+						bParentMoved = true;
+						break;
+					}
+				}
+			}
+
+			const FTransform CurrentRelative( Root->RelativeRotation,
+											  Root->RelativeLocation,
+											  Root->RelativeScale3D );
+			FTransform NewRelative = CurrentRelative;
+			FRotator NewRotator = Root->RelativeRotation;
+			if( Input.bWorldSpace )
+			{
+				FTransform World = CurrentRelative * ParentWorld;
+				if( Input.bHasLocation )
+					World.SetLocation(Input.Location);
+				if( Input.bHasQuat )
+					World.SetRotation(Input.Quat);
+				else if( Input.bHasRotator )
+					World.SetRotation(Input.Rotator.Quaternion());
+				if( Input.bHasScale )
+					World.SetScale3D(Input.Scale);
+				NewRelative = World.GetRelativeTransform(ParentWorld);
+				NewRotator = NewRelative.Rotator();
+			}
+			else
+			{
+				if( Input.bHasLocation )
+					NewRelative.SetLocation(Input.Location);
+				if( Input.bHasQuat )
+				{
+					NewRelative.SetRotation(Input.Quat);
+					NewRotator = Input.Quat.Rotator();
+				}
+				else if( Input.bHasRotator )
+				{
+					NewRelative.SetRotation(Input.Rotator.Quaternion());
+					NewRotator = Input.Rotator; // keep the Euler values as they are
+				}
+				if( Input.bHasScale )
+					NewRelative.SetScale3D(Input.Scale);
+			}
+
+			// write the values without updating the component, that happens
+			// once per subtree afterwards
+			Actors[Idx]->Modify();
+			Root->Modify();
+			Root->RelativeLocation = NewRelative.GetLocation();
+			Root->RelativeRotation = NewRotator;
+			Root->RelativeScale3D = NewRelative.GetScale3D();
+			NewWorld.Add(Root, NewRelative * ParentWorld);
+
+			if( !bParentMoved )
+			{
+				SubtreeRoots.Add(Root);
+			}
+		}
+
+		for( USceneComponent* Root : SubtreeRoots )
+		{
+			Root->UpdateComponentToWorld();
+		}
+		for( int32 Idx : Order )
+		{
+			FinishActorTransformEdit(Actors[Idx]);
+		}
+	}// void SetActorTransformsBatch()
+
+
+/**
+ * bool DecodeFloats(const FString& Base64, TArray<float>& OutValues)
+ *
+ * Decode a base64 string of packed little-endian 32bit floats.
+ * This is how binary data is sent through the text protocol.
+ */
+	bool DecodeFloats(const FString& Base64, TArray<float>& OutValues)
+	{
+		TArray<uint8> Bytes;
+		if( !FBase64::Decode(Base64, Bytes) || Bytes.Num() % sizeof(float) != 0 )
+		{
+			return false;
+		}
+		OutValues.SetNumUninitialized( Bytes.Num() / sizeof(float) );
+		FMemory::Memcpy( OutValues.GetData(), Bytes.GetData(), Bytes.Num() );
+		return true;
+	}
+
+
+/**
+ * FString EncodeFloats(const TArray<float>& Values)
+ *
+ * Encode packed little-endian 32bit floats to base64, see DecodeFloats.
+ */
+	FString EncodeFloats(const TArray<float>& Values)
+	{
+		TArray<uint8> Bytes;
+		Bytes.SetNumUninitialized( Values.Num() * sizeof(float) );
+		FMemory::Memcpy( Bytes.GetData(), Values.GetData(), Bytes.Num() );
+		return FBase64::Encode(Bytes);
+	}
+
+
+/**
+ * void AppendTransformQTS(TArray<float>& Values, const FTransform& Transform)
+ *
+ * Append the transform in the QTS layout: quaternion (x y z w), translation, scale.
+ */
+	void AppendTransformQTS(TArray<float>& Values, const FTransform& Transform)
+	{
+		const FQuat Quat = Transform.GetRotation();
+		const FVector Loc = Transform.GetLocation();
+		const FVector Scale = Transform.GetScale3D();
+		const float Record[10] = { Quat.X, Quat.Y, Quat.Z, Quat.W,
+								   Loc.X, Loc.Y, Loc.Z,
+								   Scale.X, Scale.Y, Scale.Z };
+		Values.Append(Record, 10);
+	}
+
+
+/**
+ * How m2u operations use the editor transaction buffer.
+ * Normal: every transactional operation is recorded for undo.
+ * Off: nothing is recorded, the sync can't be undone but doesn't grow the buffer.
+ * Capped: recorded, but the oldest undo entries are trimmed when the m2u
+ *   transactions use more memory than allowed (see Fm2uOpTransaction).
+ */
+	enum class Em2uTransactionMode : uint8
+	{
+		Normal,
+		Off,
+		Capped
+	};
+
+	Em2uTransactionMode& GetTransactionMode()
+	{
+		static Em2uTransactionMode Mode = Em2uTransactionMode::Normal;
+		return Mode;
+	}
+
+/**
+ * bool ShouldTransact()
+ *
+ * Pass this as bShouldActuallyTransact to every FScopedTransaction created by
+ * m2u, so the transaction mode is respected.
+ */
+	bool ShouldTransact()
+	{
+		return GetTransactionMode() != Em2uTransactionMode::Off;
+	}
 
 
 } // namespace m2uHelper
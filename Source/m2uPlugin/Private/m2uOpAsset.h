@@ -49,7 +49,9 @@ class Fm2uOpAssetImport : public Fm2uOperation
 public:
 
 	Fm2uOpAssetImport( Fm2uOperationManager* Manager = NULL )
-		:Fm2uOperation( Manager ){}
+		:Fm2uOperation( Manager ),
+		 NumImported( 0 ),
+		 NumImportsFailed( 0 ){}
 
 	bool Execute( FString Cmd, FString& Result ) override
 	{
@@ -66,6 +68,13 @@ public:
 			Result = ImportAssetsBatch(Str);
 		}
 
+		/* "Imported=<n> ImportsFailed=<n>", the entries ImportAssetsBatch
+		   imported in this session, and those that imported nothing */
+		else if( FParse::Command(&Str, TEXT("GetImportStats")))
+		{
+			Result = FString::Printf(TEXT("Imported=%i ImportsFailed=%i"), NumImported, NumImportsFailed);
+		}
+
 
 		else
 		{
@@ -73,7 +82,6 @@ public:
 			DidExecute = false;
 		}
 
-		Result = TEXT("Ok");
 		if( DidExecute )
 			return true;
 		else
@@ -120,39 +128,298 @@ public:
 
    Of course if one of the specified AssetSource values is a Folder, all files
    and subfolders will be imported.
+
+   Options in front of the list:
+   ForceNoOverwrite=True  don't overwrite existing assets
+   Workers=N  split the list across N headless editor processes, see
+              ImportAssetsSharded
+   Timeout=S  give the workers at most S seconds (3600 by default)
 */
 	FString ImportAssetsBatch(const TCHAR* Str)
 	{
-		FString AssetDestination;
-		FString AssetSource;
 		bool bForceNoOverwrite = false;
-		if(FParse::Bool(Str, TEXT("ForceNoOverwrite="), bForceNoOverwrite))
+		int32 NumWorkers = 0;
+		float Timeout = 3600.0f;
+		while( true )
 		{
-			// jump over the next space
-			Str = FCString::Strchr(Str,' ');
-			if( Str != NULL)
+			while( FChar::IsWhitespace(*Str) )
 				Str++;
+			if( FCString::Strnicmp(Str, TEXT("ForceNoOverwrite="), 17) == 0 )
+				FParse::Bool(Str, TEXT("ForceNoOverwrite="), bForceNoOverwrite);
+			else if( FCString::Strnicmp(Str, TEXT("Workers="), 8) == 0 )
+				FParse::Value(Str, TEXT("Workers="), NumWorkers);
+			else if( FCString::Strnicmp(Str, TEXT("Timeout="), 8) == 0 )
+				FParse::Value(Str, TEXT("Timeout="), Timeout);
+			else
+				break;
+			// jump over the option
+			FString Option;
+			FParse::Token(Str, Option, 0);
 		}
+
+		// collect all associations first, so nothing is imported when the
+		// list is broken
+		TArray< TPair<FString,FString> > Imports;
+		FString AssetDestination;
+		FString AssetSource;
 		while( FParse::Token(Str, AssetDestination, 0) )
 		{
-			if( FParse::Token(Str, AssetSource, 0) )
+			if( ! FParse::Token(Str, AssetSource, 0) )
 			{
-				TArray<FString> Files;
-				Files.Add(AssetSource);
-				m2uAssetHelper::ImportAssets(Files, AssetDestination, false, bForceNoOverwrite/*, &GetUserInput*/);
-			}
-			else // there is an uneven list of Destination<->FilePath infos
-			{
-// TODO: maybe store all associations in a pair-list first,
-// and start the import process only if they are even. Because
-// the reason for unevenness may be earlier than the end of the list.
-// We would import crap then maybe or create invalid destination paths
-// which in turn might crash the editor.
 				UE_LOG(LogM2U, Error, TEXT("Uneven list of Destination<->FilePath infos for Import."));
 				return TEXT("1");
 			}
+			TPair<FString,FString> Import;
+			Import.Key = AssetDestination;
+			Import.Value = AssetSource;
+			Imports.Add(Import);
+		}
+
+		if( NumWorkers > 1 && Imports.Num() > 1 )
+		{
+			return ImportAssetsSharded(Imports, NumWorkers, bForceNoOverwrite, Timeout);
+		}
+
+		for( const TPair<FString,FString>& Import : Imports )
+		{
+			TArray<FString> Files;
+			Files.Add(Import.Value);
+			if( m2uAssetHelper::ImportAssets(Files, Import.Key, false, bForceNoOverwrite/*, &GetUserInput*/).Num() > 0 )
+			{
+				++NumImported;
+			}
+			else
+			{
+				UE_LOG(LogM2U, Warning, TEXT("Importing %s into %s imported nothing."), *Import.Value, *Import.Key);
+				++NumImportsFailed;
+			}
 		}
 		return TEXT("Ok");
 	}
 
+/**
+   Import the Destination<->FilePath list with NumWorkers headless editor
+   processes (see Um2uCommandlet) on this machine.
+   The list is split by destination into one batch file per worker, every
+   worker imports its part into its own packages, saves them and writes a
+   report. All imports into one destination folder, or into folders below
+   it, go to the same worker: FBX imports create shared Material and Texture
+   packages next to the mesh, two workers importing into the same folder
+   would write the same packages at the same time. So there are never more
+   workers than independent destination folders.
+   When all workers are done, the destination paths are rescanned, so the
+   Editor knows the new assets.
+
+   This blocks until all workers are done, the Program expects the assets to
+   exist when it gets the answer. Meanwhile a progress dialog is shown that
+   can cancel the import. Workers still running after TimeoutSeconds or
+   on cancel are terminated and count as failed.
+   Assets that are loaded in this Editor can't be overwritten by a worker,
+   so this is meant for importing new assets.
+   Every worker reports how many of its entries imported something (see
+   GetImportStats), the entries of failed workers count as failed imports.
+
+   Returns "Workers=<n> Failed=<n> Imported=<n> ImportsFailed=<n> Packages=<n> Seconds=<s>"
+*/
+	FString ImportAssetsSharded(const TArray< TPair<FString,FString> >& Imports,
+								int32 NumWorkers, bool bForceNoOverwrite, float TimeoutSeconds)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		// group the destinations, a folder inside another one goes into the
+		// group of the outer one. Shorter paths first, so the outer folder
+		// always has its group when the inner one is looked at.
+		TArray<FString> DestinationPaths;
+		for( const TPair<FString,FString>& Import : Imports )
+		{
+			DestinationPaths.AddUnique(Import.Key);
+		}
+		DestinationPaths.Sort( [](const FString& A, const FString& B){ return A.Len() < B.Len(); } );
+		TArray<FString> GroupRoots;
+		TMap<FString, int32> DestinationGroups;
+		for( const FString& Path : DestinationPaths )
+		{
+			int32 Group = INDEX_NONE;
+			for( int32 Idx = 0; Idx < GroupRoots.Num() && Group == INDEX_NONE; ++Idx )
+			{
+				const FString Root = GroupRoots[Idx].EndsWith(TEXT("/")) ? GroupRoots[Idx] : GroupRoots[Idx] + TEXT("/");
+				if( Path.Equals(GroupRoots[Idx], ESearchCase::IgnoreCase) || Path.StartsWith(Root) )
+				{
+					Group = Idx;
+				}
+			}
+			if( Group == INDEX_NONE )
+			{
+				Group = GroupRoots.Add(Path);
+			}
+			DestinationGroups.Add(Path, Group);
+		}
+		TArray<int32> GroupSizes;
+		GroupSizes.AddZeroed(GroupRoots.Num());
+		for( const TPair<FString,FString>& Import : Imports )
+		{
+			++GroupSizes[DestinationGroups.FindChecked(Import.Key)];
+		}
+
+		// biggest groups first, each to the worker with the least imports
+		NumWorkers = FMath::Min(NumWorkers, GroupRoots.Num());
+		TArray<int32> GroupOrder;
+		for( int32 Idx = 0; Idx < GroupRoots.Num(); ++Idx )
+		{
+			GroupOrder.Add(Idx);
+		}
+		GroupOrder.Sort( [&GroupSizes](int32 A, int32 B){ return GroupSizes[A] > GroupSizes[B]; } );
+		TArray<int32> GroupWorkers;
+		GroupWorkers.SetNum(GroupRoots.Num());
+		TArray<int32> WorkerLoads;
+		WorkerLoads.AddZeroed(NumWorkers);
+		for( int32 Group : GroupOrder )
+		{
+			int32 Worker = 0;
+			for( int32 Idx = 1; Idx < NumWorkers; ++Idx )
+			{
+				if( WorkerLoads[Idx] < WorkerLoads[Worker] )
+				{
+					Worker = Idx;
+				}
+			}
+			GroupWorkers[Group] = Worker;
+			WorkerLoads[Worker] += GroupSizes[Group];
+		}
+
+		TArray<FString> Shards;
+		Shards.SetNum(NumWorkers);
+		for( const TPair<FString,FString>& Import : Imports )
+		{
+			const int32 Worker = GroupWorkers[DestinationGroups.FindChecked(Import.Key)];
+			Shards[Worker] += FString::Printf(TEXT("  \"%s\" \"%s\"\n"), *Import.Key, *Import.Value);
+		}
+
+		const FString ShardDir = FPaths::ConvertRelativePathToFull(FPaths::GameIntermediateDir() / TEXT("m2uImport"));
+		IFileManager::Get().MakeDirectory(*ShardDir, true);
+		const FString Executable = FPaths::ConvertRelativePathToFull(FPlatformProcess::BaseDir()) / FPlatformProcess::ExecutableName(false);
+		const FString Project = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+
+		TArray<FProcHandle> Workers;
+		TArray<FString> Reports;
+		// the number of entries every started worker imports
+		TArray<int32> WorkerImports;
+		int32 NumFailed = 0;
+		int32 TotalImported = 0;
+		int32 TotalImportsFailed = 0;
+		for( int32 Idx = 0; Idx < NumWorkers; ++Idx )
+		{
+			const FString ShardFile = ShardDir / FString::Printf(TEXT("Shard%i.m2u"), Idx);
+			const FString ReportFile = ShardDir / FString::Printf(TEXT("Shard%i.report"), Idx);
+			IFileManager::Get().Delete(*ReportFile);
+			const FString Batch = FString::Printf(TEXT("ImportAssetsBatch ForceNoOverwrite=%s\n"),
+												  bForceNoOverwrite ? TEXT("True") : TEXT("False")) + Shards[Idx];
+			if( ! FFileHelper::SaveStringToFile(Batch, *ShardFile) )
+			{
+				UE_LOG(LogM2U, Error, TEXT("Could not write %s."), *ShardFile);
+				++NumFailed;
+				TotalImportsFailed += WorkerLoads[Idx];
+				continue;
+			}
+
+			const FString Params = FString::Printf(
+				TEXT("\"%s\" -run=m2u File=\"%s\" Save Report=\"%s\" -nullrhi -unattended -nopause -nosplash"),
+				*Project, *ShardFile, *ReportFile);
+			FProcHandle Worker = FPlatformProcess::CreateProc(*Executable, *Params, false, true, true, NULL, 0, NULL, NULL);
+			if( ! Worker.IsValid() )
+			{
+				UE_LOG(LogM2U, Error, TEXT("Could not start import worker %i."), Idx);
+				++NumFailed;
+				TotalImportsFailed += WorkerLoads[Idx];
+				continue;
+			}
+			Workers.Add(Worker);
+			Reports.Add(ReportFile);
+			WorkerImports.Add(WorkerLoads[Idx]);
+		}
+		UE_LOG(LogM2U, Log, TEXT("Importing %i files with %i workers."), Imports.Num(), Workers.Num());
+
+		// poll instead of waiting for each worker, so a hanging worker can be
+		// given up on
+		FScopedSlowTask SlowTask(Workers.Num(), NSLOCTEXT("m2u", "ImportWorkers", "Importing with workers"));
+		SlowTask.MakeDialog(true);
+		const double Deadline = FPlatformTime::Seconds() + TimeoutSeconds;
+		TArray<bool> Finished;
+		Finished.AddZeroed(Workers.Num());
+		int32 NumRunning = Workers.Num();
+		int32 NumPackages = 0;
+		while( NumRunning > 0 )
+		{
+			for( int32 Idx = 0; Idx < Workers.Num(); ++Idx )
+			{
+				if( Finished[Idx] || FPlatformProcess::IsProcRunning(Workers[Idx]) )
+				{
+					continue;
+				}
+				Finished[Idx] = true;
+				--NumRunning;
+				SlowTask.EnterProgressFrame(1);
+
+				int32 ReturnCode = 1;
+				FPlatformProcess::GetProcReturnCode(Workers[Idx], &ReturnCode);
+				FPlatformProcess::CloseProc(Workers[Idx]);
+
+				FString Report;
+				int32 WorkerPackages = 0;
+				int32 WorkerImported = 0;
+				if( ReturnCode != 0 || ! FFileHelper::LoadFileToString(Report, *Reports[Idx])
+					|| ! FParse::Value(*Report, TEXT("Imported="), WorkerImported) )
+				{
+					UE_LOG(LogM2U, Error, TEXT("Import worker failed (%i), see its log."), ReturnCode);
+					++NumFailed;
+					TotalImportsFailed += WorkerImports[Idx];
+					continue;
+				}
+				FParse::Value(*Report, TEXT("Packages="), WorkerPackages);
+				NumPackages += WorkerPackages;
+				TotalImported += WorkerImported;
+				TotalImportsFailed += WorkerImports[Idx] - WorkerImported;
+			}
+			if( NumRunning == 0 )
+			{
+				break;
+			}
+
+			const bool bCancelled = SlowTask.ShouldCancel();
+			if( bCancelled || FPlatformTime::Seconds() > Deadline )
+			{
+				UE_LOG(LogM2U, Error, TEXT("Import %s, terminating %i workers."),
+					   bCancelled ? TEXT("cancelled") : TEXT("timed out"), NumRunning);
+				for( int32 Idx = 0; Idx < Workers.Num(); ++Idx )
+				{
+					if( ! Finished[Idx] )
+					{
+						FPlatformProcess::TerminateProc(Workers[Idx], true);
+						FPlatformProcess::CloseProc(Workers[Idx]);
+						++NumFailed;
+						TotalImportsFailed += WorkerImports[Idx];
+					}
+				}
+				break;
+			}
+			FPlatformProcess::Sleep(0.1f);
+		}
+
+		// the workers saved packages this Editor doesn't know about yet
+		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+		AssetRegistryModule.Get().ScanPathsSynchronous(DestinationPaths, true);
+
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		UE_LOG(LogM2U, Log, TEXT("Imported %i of %i entries into %i packages in %.2f seconds, %i failed, %i workers failed."),
+			   TotalImported, Imports.Num(), NumPackages, Seconds, TotalImportsFailed, NumFailed);
+		return FString::Printf(TEXT("Workers=%i Failed=%i Imported=%i ImportsFailed=%i Packages=%i Seconds=%.2f"),
+							   NumWorkers, NumFailed, TotalImported, TotalImportsFailed, NumPackages, Seconds);
+	}
+
+protected:
+
+	/** entries of ImportAssetsBatch that imported something, or nothing */
+	int32 NumImported;
+	int32 NumImportsFailed;
+
 };
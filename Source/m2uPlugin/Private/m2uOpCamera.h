@@ -11,8 +11,31 @@ class Fm2uOpCamera : public Fm2uOperation
 {
 public:
 
+	/** The state to set the viewport camera(s) to */
+	struct FCameraState
+	{
+		FVector Location;
+		FRotator Rotation;
+		/** which viewport to set, -1 for all, -2 for the active one */
+		int32 Viewport;
+		/** the field of view or 0 to keep the current one */
+		float FOV;
+		/** 1 for orthographic, 0 for perspective or -1 to keep the current mode */
+		int32 Ortho;
+		/** the orthographic zoom, 0 to keep the current one */
+		float OrthoWidth;
+	};
+
 	Fm2uOpCamera( Fm2uOperationManager* Manager = NULL )
-		:Fm2uOperation( Manager ){}
+		:Fm2uOperation( Manager ),
+		 bHasPendingCamera( false ),
+		 bSubscribed( false ),
+		 SubscriptionInterval( 1.0f / 30.0f ),
+		 MoveThreshold( 1.0f ),
+		 AngleThreshold( 0.5f ),
+		 TimeSinceSample( 0.0f ),
+		 LastSentLocation( FVector::ZeroVector ),
+		 LastSentRotation( FRotator::ZeroRotator ){}
 
 	bool Execute( FString Cmd, FString& Result ) override
 	{
@@ -23,26 +46,52 @@ public:
 		{
 			/* this command is meant for viewports, not for camera Actors */
 			const TCHAR* Stream = Str;
-			FVector Loc;
-			Stream = GetFVECTORSpaceDelimited( Stream, Loc );
+			FCameraState State;
+			Stream = GetFVECTORSpaceDelimited( Stream, State.Location );
 			// jump over the space
 			Stream = FCString::Strchr(Stream,' ');
 			if( Stream != NULL )
 			{
 				++Stream;
 			}
-			FRotator Rot;
-			Stream = GetFROTATORSpaceDelimited( Stream, Rot, 1.0f );
+			Stream = GetFROTATORSpaceDelimited( Stream, State.Rotation, 1.0f );
 
 			if( Stream != NULL )
 			{
-				for( int32 i=0; i<GEditor->LevelViewportClients.Num(); i++ )
+				ParseCameraOptions( Str, State );
+
+				// a streamed camera is only applied once per frame, values that
+				// arrive faster than that overwrite each other
+				bool bStream = false;
+				FParse::Bool( Str, TEXT("Stream="), bStream );
+				if( bStream )
+				{
+					PendingCamera = State;
+					bHasPendingCamera = true;
+				}
+				else
 				{
-					GEditor->LevelViewportClients[i]->SetViewLocation( Loc );
-					GEditor->LevelViewportClients[i]->SetViewRotation( Rot );
+					ApplyCamera( State );
 				}
 			}
-			GEditor->RedrawLevelEditingViewports();
+		}
+
+		else if( FParse::Command(&Str, TEXT("SubscribeCamera")))
+		{
+			/* push the active viewport's camera to the Program whenever it
+			   moved more than the thresholds, at most Rate times per second */
+			float Rate = 30.0f;
+			FParse::Value( Str, TEXT("Rate="), Rate );
+			SubscriptionInterval = 1.0f / FMath::Max( Rate, 0.1f );
+			FParse::Value( Str, TEXT("MoveThreshold="), MoveThreshold );
+			FParse::Value( Str, TEXT("AngleThreshold="), AngleThreshold );
+			bSubscribed = true;
+			TimeSinceSample = SubscriptionInterval; // sample on the next tick
+		}
+
+		else if( FParse::Command(&Str, TEXT("UnsubscribeCamera")))
+		{
+			bSubscribed = false;
 		}
 
 		else
@@ -57,4 +106,140 @@ public:
 		else
 			return false;
 	}
+
+	void Tick( float DeltaTime ) override
+	{
+		if( bHasPendingCamera )
+		{
+			bHasPendingCamera = false;
+			ApplyCamera( PendingCamera );
+		}
+
+		if( bSubscribed )
+		{
+			TimeSinceSample += DeltaTime;
+			if( TimeSinceSample >= SubscriptionInterval )
+			{
+				TimeSinceSample = 0.0f;
+				SampleActiveCamera();
+			}
+		}
+	}
+
+	/**
+	   push the active viewport's camera to the Program, if it moved enough.
+	   "Push Camera x y z rx ry rz FOV"
+	*/
+	void SampleActiveCamera()
+	{
+		FLevelEditorViewportClient* Client = GCurrentLevelEditingViewportClient;
+		if( Client == NULL || Manager == NULL )
+		{
+			return;
+		}
+		const FVector Location = Client->GetViewLocation();
+		const FRotator Rotation = Client->GetViewRotation();
+		const float Angle = FMath::RadiansToDegrees(
+			Rotation.Quaternion().AngularDistance( LastSentRotation.Quaternion() ) );
+		if( FVector::Dist( Location, LastSentLocation ) < MoveThreshold && Angle < AngleThreshold )
+		{
+			return;
+		}
+		LastSentLocation = Location;
+		LastSentRotation = Rotation;
+		Manager->Push( FString::Printf( TEXT("Camera %f %f %f %f %f %f %f"),
+										Location.X, Location.Y, Location.Z,
+										Rotation.Pitch, Rotation.Yaw, Rotation.Roll,
+										Client->ViewFOV ) );
+	}
+
+	/**
+	   read the optional parameters of a camera command
+	   Viewport=All|Active|<Index> FOV=<Degrees> Ortho=True|False OrthoWidth=<Width>
+	*/
+	void ParseCameraOptions( const TCHAR* Str, FCameraState& State )
+	{
+		State.Viewport = -1;
+		FString Viewport;
+		if( FParse::Value( Str, TEXT("Viewport="), Viewport ) && Viewport != TEXT("All") )
+		{
+			State.Viewport = (Viewport == TEXT("Active")) ? -2 : FCString::Atoi(*Viewport);
+		}
+		State.FOV = 0.0f;
+		FParse::Value( Str, TEXT("FOV="), State.FOV );
+		State.Ortho = -1;
+		bool bOrtho = false;
+		if( FParse::Bool( Str, TEXT("Ortho="), bOrtho ) )
+		{
+			State.Ortho = bOrtho ? 1 : 0;
+		}
+		State.OrthoWidth = 0.0f;
+		FParse::Value( Str, TEXT("OrthoWidth="), State.OrthoWidth );
+	}
+
+	/**
+	   set the camera of the targeted viewports and redraw only those
+	*/
+	void ApplyCamera( const FCameraState& State )
+	{
+		TArray<FLevelEditorViewportClient*> Clients;
+		if( State.Viewport == -1 )
+		{
+			Clients = GEditor->LevelViewportClients;
+		}
+		else if( State.Viewport == -2 )
+		{
+			if( GCurrentLevelEditingViewportClient != NULL )
+				Clients.Add( GCurrentLevelEditingViewportClient );
+		}
+		else if( GEditor->LevelViewportClients.IsValidIndex( State.Viewport ) )
+		{
+			Clients.Add( GEditor->LevelViewportClients[ State.Viewport ] );
+		}
+
+		for( FLevelEditorViewportClient* Client : Clients )
+		{
+			if( State.Ortho == 1 && Client->IsPerspective() )
+			{
+				Client->SetViewportType( LVT_OrthoFreelook );
+			}
+			else if( State.Ortho == 0 && !Client->IsPerspective() )
+			{
+				Client->SetViewportType( LVT_Perspective );
+			}
+			Client->SetViewLocation( State.Location );
+			Client->SetViewRotation( State.Rotation );
+			if( State.FOV > 0.0f )
+			{
+				Client->ViewFOV = State.FOV;
+			}
+			if( State.OrthoWidth > 0.0f )
+			{
+				Client->SetOrthoZoom( State.OrthoWidth );
+			}
+			Client->Invalidate();
+		}
+
+		// don't push back what the Program just sent
+		if( Clients.Contains( GCurrentLevelEditingViewportClient ) )
+		{
+			LastSentLocation = State.Location;
+			LastSentRotation = State.Rotation;
+		}
+	}
+
+protected:
+
+	/** the latest streamed camera, applied on the next Tick */
+	FCameraState PendingCamera;
+	bool bHasPendingCamera;
+
+	/** the camera subscription of the Program */
+	bool bSubscribed;
+	float SubscriptionInterval;
+	float MoveThreshold;
+	float AngleThreshold;
+	float TimeSinceSample;
+	FVector LastSentLocation;
+	FRotator LastSentRotation;
 };
@@ -13,6 +13,43 @@ class Fm2uOpLayer : public Fm2uOperation
 {
 public:
 
+	/** The desired layers of a set of Actors */
+	struct FLayerPlan
+	{
+		TArray<AActor*> Actors;
+		TArray< TArray<FName> > Layers; // same index as Actors
+		TMap<AActor*, int32> Index;
+
+		/** get the desired layers of the Actor, starts out empty */
+		TArray<FName>& GetLayers(AActor* Actor)
+		{
+			const int32* Idx = Index.Find(Actor);
+			if( Idx != NULL )
+				return Layers[*Idx];
+			Index.Add(Actor, Actors.Add(Actor));
+			return Layers[ Layers.AddDefaulted() ];
+		}
+
+		/**
+		   add the membership of the named Actors in the Layer.
+		   If bRemoveFromOthers is false, the Actors also keep their current layers.
+		 */
+		void AddMembership(const FName& Layer, const TArray<FString>& ActorNames, bool bRemoveFromOthers)
+		{
+			for( const FString& ActorName : ActorNames )
+			{
+				AActor* Actor;
+				if( !m2uHelper::GetActorByName( *ActorName, &Actor) )
+					continue;
+				const bool bIsNew = !Index.Contains(Actor);
+				TArray<FName>& ActorLayers = GetLayers(Actor);
+				if( bIsNew && !bRemoveFromOthers )
+					ActorLayers = Actor->Layers;
+				ActorLayers.AddUnique(Layer);
+			}
+		}
+	};
+
 Fm2uOpLayer( Fm2uOperationManager* Manager = NULL )
 	:Fm2uOperation( Manager ){}
 
@@ -28,44 +65,35 @@ Fm2uOpLayer( Fm2uOperationManager* Manager = NULL )
 			bool bRemoveFromOthers = true;
 			FParse::Bool(Str, TEXT("RemoveFromOthers="), bRemoveFromOthers);
 
-			UE_LOG(LogM2U, Log, TEXT("AddObjectsToLayer received: %s %s"), *LayerName, *ActorNamesList);
+			FLayerPlan Plan;
+			Plan.AddMembership(FName(*LayerName), m2uHelper::ParseList(ActorNamesList),
+							   bRemoveFromOthers);
+			ApplyLayerMemberships(Plan);
+		}
 
-			TArray<FString> ActorNames = m2uHelper::ParseList(ActorNamesList);
-			for( FString ActorName : ActorNames )
-			{
-				UE_LOG(LogM2U, Log, TEXT("Actor Names List: %s"), *ActorName);
-				AActor* Actor;
-				if( m2uHelper::GetActorByName( *ActorName, &Actor) )
-				{
-					//if( FCString::Stricmp( *RemoveFromOthers, TEXT("True") )==0 )
-					if( bRemoveFromOthers )
-					{
-						UE_LOG(LogM2U, Log, TEXT("Removing Actor %s from all Others"), *ActorName);
-						TArray<FName> AllLayerNames;
-						GEditor->Layers->AddAllLayerNamesTo(AllLayerNames);
-						GEditor->Layers->RemoveActorFromLayers(Actor, AllLayerNames);
-					}
-					UE_LOG(LogM2U, Log, TEXT("Adding Actor %s to Layer %s"), *ActorName, *LayerName);
-					GEditor->Layers->AddActorToLayer(Actor, FName(*LayerName));
-				}
-			}
+		else if( FParse::Command(&Str, TEXT("AssignObjectsToLayers")))
+		{
+			AssignObjectsToLayers(Str);
+		}
+
+		else if( FParse::Command(&Str, TEXT("SyncLayers")))
+		{
+			SyncLayers(Str);
 		}
 
 		else if( FParse::Command(&Str, TEXT("RemoveObjectsFromAllLayers")))
 		{
 			FString ActorNamesList = FParse::Token(Str,0);
-			TArray<FString> ActorNames = m2uHelper::ParseList(ActorNamesList);
-			for( FString ActorName : ActorNames )
+			FLayerPlan Plan;
+			for( const FString& ActorName : m2uHelper::ParseList(ActorNamesList) )
 			{
 				AActor* Actor;
 				if( m2uHelper::GetActorByName( *ActorName, &Actor) )
 				{
-					UE_LOG(LogM2U, Log, TEXT("Removing Actor %s from all Layers."), *ActorName);
-					TArray<FName> AllLayerNames;
-					GEditor->Layers->AddAllLayerNamesTo(AllLayerNames);
-					GEditor->Layers->RemoveActorFromLayers(Actor, AllLayerNames);
+					Plan.GetLayers(Actor).Empty();
 				}
 			}
+			ApplyLayerMemberships(Plan);
 		}
 
 		else if( FParse::Command(&Str, TEXT("HideLayer")))
@@ -109,4 +137,247 @@ Fm2uOpLayer( Fm2uOperationManager* Manager = NULL )
 		else
 			return false;
 	}
+
+/**
+   read the bool Option from the first line of a batch command.
+   The line is only taken as the options line if the option is all there is
+   on it, otherwise Str is left alone and the line is read as data.
+   @return true if the first line was the options line
+ */
+	bool ParseOptionLine(const TCHAR*& Str, const TCHAR* Option, bool& bValue)
+	{
+		const TCHAR* LineStart = Str;
+		FString Line;
+		if( !FParse::Line(&Str, Line, 0) )
+			return false;
+		const TCHAR* LineStr = *Line;
+		FString Token;
+		bool bHasOption = false;
+		while( FParse::Token(LineStr, Token, 0) )
+		{
+			if( !Token.StartsWith(Option) )
+			{
+				Str = LineStart;
+				return false;
+			}
+			bHasOption = true;
+		}
+		if( bHasOption )
+			FParse::Bool(*Line, Option, bValue);
+		return true;
+	}
+
+/**
+   assign Actors to many layers in one go.
+   The first line may contain the RemoveFromOthers=True/False option (default
+   True), every other line is expected to be "LayerName [Actor1,Actor2,...]".
+   Without the option, the first line is data as well.
+   With RemoveFromOthers, every listed Actor will afterwards only be in the
+   layers it was listed for.
+ */
+	void AssignObjectsToLayers(const TCHAR* Str)
+	{
+		bool bRemoveFromOthers = true;
+		ParseOptionLine(Str, TEXT("RemoveFromOthers="), bRemoveFromOthers);
+
+		FString Line;
+		FLayerPlan Plan;
+		while( FParse::Line(&Str, Line, 0) )
+		{
+			if( Line.IsEmpty() )
+				continue;
+			const TCHAR* LineStr = *Line;
+			const FString LayerName = FParse::Token(LineStr,0);
+			const FString ActorNamesList = FParse::Token(LineStr,0);
+			Plan.AddMembership(FName(*LayerName), m2uHelper::ParseList(ActorNamesList),
+							   bRemoveFromOthers);
+		}
+		ApplyLayerMemberships(Plan);
+	}
+
+
+/**
+   make the Editor's layers match the complete desired layer state.
+   The first line may contain the DeleteOthers=True/False option (default True)
+   every other line (and the first without the option) is expected to be
+   "LayerName [Actor1,Actor2,...] Visible=True/False"
+   for every layer there should be.
+
+   The desired state is compared with the current one and only the differences
+   are applied: missing layers are created, layers not in the list are deleted
+   (with DeleteOthers), visibility is only set where it differs, and only the
+   Actors whose membership changed are edited.
+   Finding unlisted members of the synced layers still needs one walk over all
+   Actors, and the Editor walks all Actors for every deleted layer.
+ */
+	void SyncLayers(const TCHAR* Str)
+	{
+		bool bDeleteOthers = true;
+		ParseOptionLine(Str, TEXT("DeleteOthers="), bDeleteOthers);
+		FString Line;
+
+		// read the desired state
+		TMap<FName, bool> DesiredVisibility;
+		TArray<FName> DesiredOrder;
+		FLayerPlan Plan;
+		while( FParse::Line(&Str, Line, 0) )
+		{
+			if( Line.IsEmpty() )
+				continue;
+			const TCHAR* LineStr = *Line;
+			const FName LayerName( *FParse::Token(LineStr,0) );
+			const FString ActorNamesList = FParse::Token(LineStr,0);
+			bool bVisible = true;
+			FParse::Bool(LineStr, TEXT("Visible="), bVisible);
+			if( !DesiredVisibility.Contains(LayerName) )
+				DesiredOrder.Add(LayerName);
+			DesiredVisibility.Add(LayerName, bVisible);
+			Plan.AddMembership(LayerName, m2uHelper::ParseList(ActorNamesList), true);
+		}
+
+		// compare with the current layers
+		TArray< TWeakObjectPtr<ULayer> > CurrentLayers;
+		GEditor->Layers->AddAllLayersTo(CurrentLayers);
+		TSet<FName> Existing;
+		bool bSyncedLayersHaveMembers = false;
+		int32 NumDeleted = 0;
+		int32 NumVisibilityChanged = 0;
+		for( const TWeakObjectPtr<ULayer>& Layer : CurrentLayers )
+		{
+			if( !Layer.IsValid() )
+				continue;
+			const bool* bVisible = DesiredVisibility.Find(Layer->LayerName);
+			if( bVisible == NULL )
+			{
+				if( bDeleteOthers )
+				{
+					GEditor->Layers->DeleteLayer(Layer->LayerName);
+					++NumDeleted;
+				}
+				continue;
+			}
+			Existing.Add(Layer->LayerName);
+			for( const FLayerActorStats& Stats : Layer->ActorStats )
+			{
+				if( Stats.Total > 0 )
+					bSyncedLayersHaveMembers = true;
+			}
+			if( Layer->bIsVisible != *bVisible )
+			{
+				GEditor->Layers->SetLayerVisibility(Layer->LayerName, *bVisible);
+				++NumVisibilityChanged;
+			}
+		}
+		for( const FName& LayerName : DesiredOrder )
+		{
+			if( !Existing.Contains(LayerName) )
+			{
+				GEditor->Layers->CreateLayer(LayerName);
+				if( !DesiredVisibility.FindChecked(LayerName) )
+					GEditor->Layers->SetLayerVisibility(LayerName, false);
+			}
+		}
+
+		// listed Actors keep their memberships in layers that are not synced
+		for( int32 Idx = 0; Idx < Plan.Actors.Num(); ++Idx )
+		{
+			for( const FName& Layer : Plan.Actors[Idx]->Layers )
+			{
+				if( !DesiredVisibility.Contains(Layer) )
+					Plan.Layers[Idx].AddUnique(Layer);
+			}
+		}
+
+		// Actors that are in a synced layer now, but not listed, leave it.
+		// The Editor keeps no index of the members of a layer, so they can only
+		// be found by walking all Actors. That is skipped when none of the
+		// synced layers has members (the layer stats tell us that).
+		if( bSyncedLayersHaveMembers )
+		{
+			auto World = GEditor->GetEditorWorldContext().World();
+			for( FActorIterator It(World); It; ++It )
+			{
+				AActor* Actor = *It;
+				if( Actor->Layers.Num() == 0 || Plan.Index.Contains(Actor) )
+					continue;
+				bool bInSyncedLayer = false;
+				for( const FName& Layer : Actor->Layers )
+				{
+					if( DesiredVisibility.Contains(Layer) )
+					{
+						bInSyncedLayer = true;
+						break;
+					}
+				}
+				if( !bInSyncedLayer )
+					continue;
+				TArray<FName>& ActorLayers = Plan.GetLayers(Actor);
+				for( const FName& Layer : Actor->Layers )
+				{
+					if( !DesiredVisibility.Contains(Layer) )
+						ActorLayers.Add(Layer);
+				}
+			}
+		}
+
+		UE_LOG(LogM2U, Log, TEXT("SyncLayers: %i layers created, %i deleted, %i visibility changes."),
+			   DesiredOrder.Num() - Existing.Num(), NumDeleted, NumVisibilityChanged);
+		ApplyLayerMemberships(Plan);
+	}
+
+/**
+   make every Actor of the Plan a member of exactly its desired layers.
+
+   Adding and removing Actors one by one makes the Editor update and notify
+   about the layers for every single Actor. Instead, only the differences to
+   the current memberships are computed, grouped by layer, and applied with one
+   call per changed layer.
+
+   @return the number of Actors whose membership changed
+ */
+	int32 ApplyLayerMemberships(const FLayerPlan& Plan)
+	{
+		const TArray<AActor*>& Actors = Plan.Actors;
+		const TArray< TArray<FName> >& Layers = Plan.Layers;
+		TMap< FName, TArray<AActor*> > ToAdd;
+		TMap< FName, TArray<AActor*> > ToRemove;
+		int32 NumChanged = 0;
+		for( int32 Idx = 0; Idx < Actors.Num(); ++Idx )
+		{
+			AActor* Actor = Actors[Idx];
+			bool bChanged = false;
+			for( const FName& Layer : Layers[Idx] )
+			{
+				if( !Actor->Layers.Contains(Layer) )
+				{
+					ToAdd.FindOrAdd(Layer).Add(Actor);
+					bChanged = true;
+				}
+			}
+			for( const FName& Layer : Actor->Layers )
+			{
+				if( !Layers[Idx].Contains(Layer) )
+				{
+					ToRemove.FindOrAdd(Layer).Add(Actor);
+					bChanged = true;
+				}
+			}
+			if( bChanged )
+				++NumChanged;
+		}
+
+		for( auto It = ToRemove.CreateConstIterator(); It; ++It )
+		{
+			GEditor->Layers->RemoveActorsFromLayer(It.Value(), It.Key());
+		}
+		// this will also create the layers that don't exist yet
+		for( auto It = ToAdd.CreateConstIterator(); It; ++It )
+		{
+			GEditor->Layers->AddActorsToLayer(It.Value(), It.Key());
+		}
+
+		UE_LOG(LogM2U, Log, TEXT("Layer membership: %i of %i Actors changed, %i layers added to, %i removed from."),
+			   NumChanged, Actors.Num(), ToAdd.Num(), ToRemove.Num());
+		return NumChanged;
+	}
 };
@@ -22,7 +22,27 @@ Fm2uOpObjectTransform( Fm2uOperationManager* Manager = NULL )
 
 		if( FParse::Command(&Str, TEXT("TransformObject")))
 		{
-			Result = TransformObject(Str);
+			Result = TransformObject(Str, false);
+		}
+
+		else if( FParse::Command(&Str, TEXT("TransformObjectWorld")))
+		{
+			Result = TransformObject(Str, true);
+		}
+
+		else if( FParse::Command(&Str, TEXT("TransformObjectBatch")))
+		{
+			Result = TransformObjectBatch(Str);
+		}
+
+		else if( FParse::Command(&Str, TEXT("TransformObjectsPacked")))
+		{
+			Result = TransformObjectsPacked(Str);
+		}
+
+		else if( FParse::Command(&Str, TEXT("GetTransforms")))
+		{
+			Result = GetTransforms(Str);
 		}
 
 		else
@@ -37,7 +57,12 @@ Fm2uOpObjectTransform( Fm2uOperationManager* Manager = NULL )
 			return false;
 	}
 
-	FString TransformObject(const TCHAR* Str)
+/**
+   set the transform of one actor from text, see ParseTransformFromText for the
+   supported formats.
+   TransformObject sets relative transforms, TransformObjectWorld world-space ones.
+ */
+	FString TransformObject(const TCHAR* Str, bool bWorldSpace)
 	{
 		const FString ActorName = FParse::Token(Str,0);
 		AActor* Actor = NULL;
@@ -49,11 +74,239 @@ Fm2uOpObjectTransform( Fm2uOperationManager* Manager = NULL )
 			return TEXT("1");
 		}
 
-		m2uHelper::SetActorTransformRelativeFromText(Actor, Str);
+		if( bWorldSpace )
+			m2uHelper::SetActorTransformWorldFromText(Actor, Str);
+		else
+			m2uHelper::SetActorTransformRelativeFromText(Actor, Str);
 
 		GEditor->RedrawLevelEditingViewports();
 		return TEXT("Ok");
 	}
+
+/**
+   set the transforms of multiple actors from the string,
+   expects every line to be "ActorName T=(..) R=(..) S=(..)" as for
+   TransformObject, add World=True to a line for world-space values.
+   Parents are moved before their children, so every hierarchy updates once.
+
+   Returns the number of actors that could not be found, 0 if all went fine.
+ */
+	FString TransformObjectBatch(const TCHAR* Str)
+	{
+		TArray<AActor*> Actors;
+		TArray<m2uHelper::Fm2uTransformInput> Inputs;
+		int32 NumNotFound = 0;
+		FString Line;
+		while( FParse::Line(&Str, Line, 0) )
+		{
+			if( Line.IsEmpty() )
+				continue;
+			const TCHAR* LineStr = *Line;
+			const FString ActorName = FParse::Token(LineStr,0);
+			AActor* Actor = NULL;
+			if(!m2uHelper::GetActorByName(*ActorName, &Actor) || Actor == NULL)
+			{
+				UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *ActorName);
+				++NumNotFound;
+				continue;
+			}
+			m2uHelper::Fm2uTransformInput& Input = Inputs[ Inputs.AddDefaulted() ];
+			m2uHelper::ParseTransformFromText(LineStr, Input);
+			Actors.Add(Actor);
+		}
+
+		m2uHelper::SetActorTransformsBatch(Actors, Inputs);
+
+		GEditor->RedrawLevelEditingViewports();
+		return FString::FromInt(NumNotFound);
+	}
+
+/**
+   set the transforms of many actors from packed binary float data.
+   TransformObjectsPacked <Layout> <Space> [name1,name2,...] <Base64Data>
+
+   Layout is one of
+   QTS: 10 floats per actor, quaternion (x y z w), translation, scale
+   M:   16 floats per actor, a matrix row by row as in FMatrix
+   Space is either Relative or World.
+   The data is the base64 encoded array of little-endian 32bit floats, one
+   record for every name in the list, in the same order.
+
+   Returns the number of actors that could not be found, 0 if all went fine.
+ */
+	FString TransformObjectsPacked(const TCHAR* Str)
+	{
+		const FString Layout = FParse::Token(Str,0);
+		const FString Space = FParse::Token(Str,0);
+		const FString ActorNamesList = FParse::Token(Str,0);
+		const FString Data = FParse::Token(Str,0);
+
+		int32 Stride = 0;
+		if( Layout == TEXT("QTS") )
+			Stride = 10;
+		else if( Layout == TEXT("M") )
+			Stride = 16;
+		else
+		{
+			UE_LOG(LogM2U, Error, TEXT("Unknown transform layout %s."), *Layout);
+			return TEXT("1");
+		}
+		const bool bWorldSpace = (Space == TEXT("World"));
+
+		TArray<FString> ActorNames = m2uHelper::ParseList(ActorNamesList);
+		TArray<float> Values;
+		if( !m2uHelper::DecodeFloats(Data, Values) || Values.Num() != ActorNames.Num() * Stride )
+		{
+			UE_LOG(LogM2U, Error, TEXT("Transform data does not match the %i names."), ActorNames.Num());
+			return TEXT("1");
+		}
+
+		TArray<AActor*> Actors;
+		TArray<m2uHelper::Fm2uTransformInput> Inputs;
+		int32 NumNotFound = 0;
+		for( int32 Idx = 0; Idx < ActorNames.Num(); ++Idx )
+		{
+			AActor* Actor = NULL;
+			if(!m2uHelper::GetActorByName(*ActorNames[Idx], &Actor) || Actor == NULL)
+			{
+				++NumNotFound;
+				continue;
+			}
+
+			const float* Record = &Values[Idx * Stride];
+			m2uHelper::Fm2uTransformInput& Input = Inputs[ Inputs.AddDefaulted() ];
+			Input.bWorldSpace = bWorldSpace;
+			if( Stride == 16 )
+			{
+				FMatrix Matrix;
+				FMemory::Memcpy( &Matrix.M[0][0], Record, 16 * sizeof(float) );
+				Input.SetFromTransform( FTransform(Matrix) );
+			}
+			else
+			{
+				FQuat Quat(Record[0], Record[1], Record[2], Record[3]);
+				Quat.Normalize();
+				Input.SetFromTransform( FTransform( Quat,
+													FVector(Record[4], Record[5], Record[6]),
+													FVector(Record[7], Record[8], Record[9]) ) );
+			}
+			Actors.Add(Actor);
+		}
+
+		m2uHelper::SetActorTransformsBatch(Actors, Inputs);
+
+		GEditor->RedrawLevelEditingViewports();
+		return FString::FromInt(NumNotFound);
+	}
+
+/**
+   read back the transforms of many actors as packed binary float data.
+   GetTransforms [name1,name2,...] Space=Relative Names=Names ChunkSize=0 Chunk=0
+   or
+   GetTransforms All ...
+   for all actors in the current level.
+
+   Space is Relative, World or Both. The records are in the QTS layout (see
+   TransformObjectsPacked), with Both, the relative record comes first.
+   Names=Handles returns the handles "#12" instead of the names.
+
+   For big levels, the result can be fetched in chunks of ChunkSize actors.
+   Requesting Chunk=0 takes a snapshot of the actors, the following chunks
+   are taken from that snapshot, so the list stays consistent.
+
+   The result is "Total=<N> Chunk=<K> Chunks=<M> [name1,name2,...] <Base64Data>"
+   Actors that were deleted since the snapshot have an empty name and an
+   identity transform.
+ */
+	FString GetTransforms(const TCHAR* Str)
+	{
+		const FString Selector = FParse::Token(Str,0);
+		FString Space = TEXT("Relative");
+		FParse::Value(Str, TEXT("Space="), Space);
+		FString NameMode = TEXT("Names");
+		FParse::Value(Str, TEXT("Names="), NameMode);
+		int32 ChunkSize = 0;
+		FParse::Value(Str, TEXT("ChunkSize="), ChunkSize);
+		int32 Chunk = 0;
+		FParse::Value(Str, TEXT("Chunk="), Chunk);
+
+		if( Chunk == 0 )
+		{
+			Snapshot.Empty();
+			if( Selector == TEXT("All") )
+			{
+				ULevel* Level = GEditor->GetEditorWorldContext().World()->GetCurrentLevel();
+				for( AActor* Actor : Level->Actors )
+				{
+					if( Actor != NULL && Actor->GetRootComponent() != NULL )
+						Snapshot.Add(Actor);
+				}
+			}
+			else
+			{
+				for( const FString& ActorName : m2uHelper::ParseList(Selector) )
+				{
+					AActor* Actor = NULL;
+					m2uHelper::GetActorByName(*ActorName, &Actor);
+					Snapshot.Add(Actor);
+				}
+			}
+		}
+
+		const int32 Total = Snapshot.Num();
+		if( ChunkSize <= 0 )
+		{
+			ChunkSize = FMath::Max(Total, 1);
+		}
+		const int32 NumChunks = FMath::DivideAndRoundUp(Total, ChunkSize);
+		const int32 First = FMath::Min(Chunk * ChunkSize, Total);
+		const int32 Last = FMath::Min(First + ChunkSize, Total);
+
+		const bool bRelative = (Space != TEXT("World"));
+		const bool bWorld = (Space != TEXT("Relative"));
+		const bool bHandles = (NameMode == TEXT("Handles"));
+
+		TArray<FString> Names;
+		TArray<float> Values;
+		Values.Reserve( (Last - First) * (bRelative && bWorld ? 20 : 10) );
+		for( int32 Idx = First; Idx < Last; ++Idx )
+		{
+			AActor* Actor = Snapshot[Idx].Get();
+			USceneComponent* Root = (Actor != NULL) ? Actor->GetRootComponent() : NULL;
+			if( Root == NULL )
+			{
+				Names.Add(FString());
+				if( bRelative )
+					m2uHelper::AppendTransformQTS(Values, FTransform::Identity);
+				if( bWorld )
+					m2uHelper::AppendTransformQTS(Values, FTransform::Identity);
+				continue;
+			}
+			Names.Add( bHandles ? m2uHelper::GetActorHandleString(Actor) : Actor->GetName() );
+			if( bRelative )
+				m2uHelper::AppendTransformQTS(Values, FTransform( Root->RelativeRotation,
+																   Root->RelativeLocation,
+																   Root->RelativeScale3D ));
+			if( bWorld )
+				m2uHelper::AppendTransformQTS(Values, Root->ComponentToWorld);
+		}
+
+		if( Chunk >= NumChunks - 1 )
+		{
+			// the last chunk was fetched, no need to hold the snapshot
+			Snapshot.Empty();
+		}
+
+		return FString::Printf(TEXT("Total=%i Chunk=%i Chunks=%i [%s] %s"),
+							   Total, Chunk, NumChunks,
+							   *FString::Join(Names, TEXT(",")),
+							   *m2uHelper::EncodeFloats(Values));
+	}
+
+protected:
+
+	/** the actors for chunked GetTransforms requests */
+	TArray< TWeakObjectPtr<AActor> > Snapshot;
 };
 
 
@@ -99,6 +352,16 @@ Fm2uOpObjectName( Fm2uOperationManager* Manager = NULL )
 			Result = ResultName.ToString();
 		}
 
+		else if( FParse::Command(&Str, TEXT("RenameObjects")))
+		{
+			Result = RenameObjects(Str);
+		}
+
+		else if( FParse::Command(&Str, TEXT("GetActorHandles")))
+		{
+			Result = GetActorHandles(Str);
+		}
+
 		else
 		{
 // cannot handle the passed command
@@ -111,6 +374,149 @@ Fm2uOpObjectName( Fm2uOperationManager* Manager = NULL )
 			return false;
 	}
 
+/**
+ * FString GetActorHandles(const TCHAR* Str)
+ *
+ * Get the handles for a list of Actors, the Program can use them instead of
+ * the names in all further commands.
+ * GetActorHandles [Name1,Name2,...]
+ *
+ * @return A list of handles in the same order [#1,#2,...] the entry is empty
+ *         for Actors that could not be found.
+ */
+	FString GetActorHandles(const TCHAR* Str)
+	{
+		const TArray<FString> ActorNames = m2uHelper::ParseList( FParse::Token(Str,0) );
+		TArray<FString> Handles;
+		for( const FString& ActorName : ActorNames )
+		{
+			AActor* Actor = NULL;
+			if( m2uHelper::GetActorByName(*ActorName, &Actor) && Actor != NULL )
+				Handles.Add( m2uHelper::GetActorHandleString(Actor) );
+			else
+				Handles.Add( FString() );
+		}
+		return FString(TEXT("[")) + FString::Join(Handles, TEXT(",")) + TEXT("]");
+	}
+
+/**
+ * FString RenameObjects(const TCHAR* Str)
+ *
+ * Rename many Actors in one go.
+ * RenameObjects [OldName1,OldName2,...] [NewName1,NewName2,...]
+ *
+ * @return A list of the resulting names in the same order [Result1,Result2,...]
+ *         the result is empty for Actors that could not be found.
+ *
+ * Renaming one by one would fail when the Actors swap names, or when one takes
+ * the name another one gives up later in the list. So all target names are
+ * planned first: Actors that occupy a name another Actor of the set wants, are
+ * moved to a temporary name before the actual renaming happens.
+ * Names that are taken by an Actor outside of the set, or requested twice, are
+ * handled like with RenameActor, the Actor will keep its name, or get a free
+ * name based on the desired one if it was moved to a temporary name.
+ */
+	FString RenameObjects(const TCHAR* Str)
+	{
+		const TArray<FString> OldNames = m2uHelper::ParseList( FParse::Token(Str,0) );
+		const TArray<FString> NewNames = m2uHelper::ParseList( FParse::Token(Str,0) );
+		if( OldNames.Num() != NewNames.Num() )
+		{
+			UE_LOG(LogM2U, Error, TEXT("RenameObjects: got %i names but %i new names."), OldNames.Num(), NewNames.Num());
+			return TEXT("1");
+		}
+
+		// 1. Plan the new names
+		TArray<AActor*> Actors;
+		TArray<FName> Targets;
+		Actors.SetNumZeroed(OldNames.Num());
+		Targets.SetNumZeroed(OldNames.Num());
+		TMap<FName, int32> Claimed; // target name -> the entry that gets it
+		for( int32 Idx = 0; Idx < OldNames.Num(); ++Idx )
+		{
+			AActor* Actor = NULL;
+			if(!m2uHelper::GetActorByName(*OldNames[Idx], &Actor) || Actor == NULL)
+			{
+				UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *OldNames[Idx]);
+				continue;
+			}
+			Actors[Idx] = Actor;
+			FName Target;
+			if( !m2uHelper::GetSanitizedFName(NewNames[Idx], Target) )
+			{
+				Target = Actor->GetFName();
+			}
+			else if( Target == NAME_None )
+			{
+				Target = FName( *m2uHelper::M2U_GENERATED_NAME );
+			}
+			Targets[Idx] = Target;
+			if( Target != Actor->GetFName() && !Claimed.Contains(Target) )
+			{
+				Claimed.Add(Target, Idx);
+			}
+		}
+
+		// 2. Move Actors out of the way that occupy a name that is wanted by
+		// another Actor of the set
+		UObject* NewOuter = NULL; // NULL = use the current Outer
+		const ERenameFlags RenFlags = REN_DontCreateRedirectors;
+		const ERenameFlags TestFlags = REN_Test | REN_DoNotDirty | REN_NonTransactional | RenFlags;
+		TArray<bool> bMovedAway;
+		bMovedAway.SetNumZeroed(Actors.Num());
+		for( int32 Idx = 0; Idx < Actors.Num(); ++Idx )
+		{
+			AActor* Actor = Actors[Idx];
+			if( Actor == NULL || Targets[Idx] == Actor->GetFName() )
+				continue;
+			const int32* Claimer = Claimed.Find(Actor->GetFName());
+			if( Claimer != NULL && *Claimer != Idx )
+			{
+				const FName TempName = MakeUniqueObjectName(Actor->GetOuter(), Actor->GetClass(),
+															 FName(TEXT("m2uRenameTemp")));
+				Actor->Rename( *TempName.ToString(), NewOuter, RenFlags );
+				bMovedAway[Idx] = true;
+			}
+		}
+
+		// 3. Rename all Actors to their planned names
+		TArray<FString> ResultNames;
+		for( int32 Idx = 0; Idx < Actors.Num(); ++Idx )
+		{
+			AActor* Actor = Actors[Idx];
+			if( Actor == NULL )
+			{
+				ResultNames.Add(FString());
+				continue;
+			}
+			const FName Target = Targets[Idx];
+			if( Actor->GetFName() != Target )
+			{
+				const int32* Claimer = Claimed.Find(Target);
+				const bool bIsClaimer = (Claimer != NULL && *Claimer == Idx);
+				if( bIsClaimer && Actor->Rename( *Target.ToString(), NewOuter, TestFlags ) )
+				{
+					Actor->Rename( *Target.ToString(), NewOuter, RenFlags );
+				}
+				else if( bMovedAway[Idx] )
+				{
+					// the Actor gave up its name, so it has to get some proper name
+					const FName FreeName = m2uHelper::GetFreeName(Target.ToString());
+					Actor->Rename( *FreeName.ToString(), NewOuter, RenFlags );
+				}
+				// else unable to rename the Actor to that name, keep the old one
+			}
+			const FName ResultFName = Actor->GetFName();
+			if( Actor->GetActorLabel() != ResultFName.ToString() )
+			{
+				Actor->SetActorLabel(ResultFName.ToString()); // this won't change the ID
+			}
+			ResultNames.Add(ResultFName.ToString());
+		}
+
+		return FString(TEXT("[")) + FString::Join(ResultNames, TEXT(",")) + TEXT("]");
+	}// FString RenameObjects()
+
 /**
  * FName RenameActor( AActor* Actor, const FString& Name)
  *
@@ -165,26 +571,19 @@ Fm2uOpObjectName( Fm2uOperationManager* Manager = NULL )
 	{
 		// 1. Generate a valid FName from the String
 
-		FString GeneratedName = Name;
-		// create valid object name from the string. (remove invalid characters)
-		for( int32 BadCharacterIndex = 0; BadCharacterIndex < ARRAY_COUNT( INVALID_OBJECTNAME_CHARACTERS ) - 1; ++BadCharacterIndex )
-		{
-			const TCHAR TestChar[2] = { INVALID_OBJECTNAME_CHARACTERS[ BadCharacterIndex ], 0 };
-			const int32 NumReplacedChars = GeneratedName.ReplaceInline( TestChar, TEXT( "" ) );
-		}
+		FName NewFName;
+		const bool bHasName = m2uHelper::GetSanitizedFName( Name, NewFName );
 		// is there still a name, or was it stripped completely (pure invalid name)
 		// we don't change the name then. The calling function should check
 		// this and maybe print an error-message or so.
-		if( GeneratedName.IsEmpty() )
+		// NOTE: "None" would also result in NAME_None, that is a valid name to
+		// assign but in maya the name will be something like "_110" while here
+		// it will be "None" with no number. So althoug renaming "succeeded" the
+		// names differ.
+		if( !bHasName )
 		{
 			return Actor->GetFName();
 		}
-		FName NewFName( *GeneratedName );
-
-		// check if name is "None", NAME_None, that is a valid name to assign
-		// but in maya the name will be something like "_110" while here it will
-		// be "None" with no number. So althoug renaming "succeeded" the names
-		// differ.
 		if( NewFName == NAME_None )
 		{
 			NewFName = FName( *m2uHelper::M2U_GENERATED_NAME );
@@ -257,7 +656,11 @@ Fm2uOpObjectDelete( Fm2uOperationManager* Manager = NULL )
 			// but this is probably in 99% of the cases not necessary
 			GEditor->SelectNone(true, true, false);
 			const FString ActorName = FParse::Token(Str,0);
-			AActor* Actor = GEditor->SelectNamedActor(*ActorName);
+			AActor* Actor = NULL;
+			if( m2uHelper::GetActorByName(*ActorName, &Actor) )
+			{
+				GEditor->SelectActor(Actor, true, false);
+			}
 			auto World = GEditor->GetEditorWorldContext().World();
 			((UUnrealEdEngine*)GEditor)->edactDeleteSelected(World);
 
@@ -312,8 +715,7 @@ Fm2uOpObjectDuplicate( Fm2uOperationManager* Manager = NULL )
 			// the name that is desired for the object
 			const FString DupName = FParse::Token(Str,0);
 
-			// TODO: enable transactions
-			//const FScopedTransaction Transaction( NSLOCTEXT("UnrealEd", "DuplicateActors", "Duplicate Actors") );
+			const FScopedTransaction Transaction( TEXT("m2u"), NSLOCTEXT("UnrealEd", "DuplicateActors", "Duplicate Actors"), NULL, m2uHelper::ShouldTransact() );
 
 			// select only the actor we want to duplicate
 			GEditor->SelectNone(true, true, false);
@@ -428,6 +830,9 @@ Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
 		// Parse additional parameters
 		bool bEditIfExists = true;
 		FParse::Bool(Str, TEXT("EditIfExists="), bEditIfExists);
+		// Append the Actor's handle to the result "Name #Handle"
+		bool bReturnHandle = false;
+		FParse::Bool(Str, TEXT("ReturnHandle="), bReturnHandle);
 		// Note: Replacing would happen if the object to create is of a different type 
 		// than the one that already has that desired name. 
 		// it is very unlikely that in that case not simply a new name can be used
@@ -444,6 +849,12 @@ Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
 			if(m2uHelper::GetActorByName( *ActorName, &Actor))
 			{
 				UE_LOG(LogM2U, Log, TEXT("Found Actor for editing: %s"), *ActorName);
+				// make sure the Actor uses the asset
+				UObject* Asset = m2uAssetHelper::GetAssetFromPath(AssetName);
+				if( Asset != NULL )
+				{
+					m2uHelper::SetActorAsset(Actor, Asset);
+				}
 			}
 			else 
 				UE_LOG(LogM2U, Warning, TEXT("Name already taken, but no Actor with that name found: %s"), *ActorName);
@@ -467,11 +878,14 @@ Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
 		// (no need in searching it again later
 		m2uHelper::SetActorTransformRelativeFromText(Actor, Str);
 		// TODO: set other attributes
-		// TODO: set asset-reference (mesh) at least if bEdit
 
 		// TODO: we might have other property data in that string
 		// we need a function to set light radius and all that
 
+		if( bReturnHandle )
+		{
+			return ActorFName.ToString() + TEXT(" ") + m2uHelper::GetActorHandleString(Actor);
+		}
 		return ActorFName.ToString();
 	}
 
@@ -519,7 +933,16 @@ Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
 		UObject* Asset = m2uAssetHelper::GetAssetFromPath(AssetPath);
 		if( Asset == NULL)
 			return NULL;
+		return AddNewActorFromAsset(Asset, InLevel, Name, bSelectActor, ObjectFlags);
+	}
 
+	/** Same as above, for an already loaded Asset */
+	AActor* AddNewActorFromAsset( UObject* Asset,
+								  ULevel* InLevel,
+								  FName Name = NAME_None,
+								  bool bSelectActor = true,
+								  EObjectFlags ObjectFlags = RF_Transactional)
+	{
 		//UClass* AssetClass = Asset->GetClass();
 		
 		if( Name == NAME_None)
@@ -575,6 +998,99 @@ Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
 };
 
 
+class Fm2uOpObjectAsset : public Fm2uOperation
+{
+public:
+
+Fm2uOpObjectAsset( Fm2uOperationManager* Manager = NULL )
+	:Fm2uOperation( Manager ){}
+
+	bool Execute( FString Cmd, FString& Result ) override
+	{
+		const TCHAR* Str = *Cmd;
+		bool DidExecute = true;
+
+		if( FParse::Command(&Str, TEXT("SetActorAsset")))
+		{
+			const FString ActorName = FParse::Token(Str,0);
+			const FString AssetPath = FParse::Token(Str,0);
+			TMap<FString, UObject*> AssetCache;
+			Result = SetActorAsset(ActorName, AssetPath, AssetCache) ? TEXT("0") : TEXT("1");
+			GEditor->RedrawLevelEditingViewports();
+		}
+
+		else if( FParse::Command(&Str, TEXT("SetActorAssetBatch")))
+		{
+			Result = SetActorAssetBatch(Str);
+		}
+
+		else
+		{
+// cannot handle the passed command
+			DidExecute = false;
+		}
+
+		if( DidExecute )
+			return true;
+		else
+			return false;
+	}
+
+/**
+   make the Actor use another asset (mesh) without re-creating it,
+   see m2uHelper::SetActorAsset.
+   Assets are looked up once per path in the AssetCache.
+ */
+	bool SetActorAsset(const FString& ActorName, const FString& AssetPath,
+					   TMap<FString, UObject*>& AssetCache)
+	{
+		AActor* Actor = NULL;
+		if(!m2uHelper::GetActorByName(*ActorName, &Actor) || Actor == NULL)
+		{
+			UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *ActorName);
+			return false;
+		}
+
+		UObject** Cached = AssetCache.Find(AssetPath);
+		UObject* Asset = (Cached != NULL) ? *Cached :
+			AssetCache.Add(AssetPath, m2uAssetHelper::GetAssetFromPath(AssetPath));
+		if( Asset == NULL )
+		{
+			return false;
+		}
+
+		return m2uHelper::SetActorAsset(Actor, Asset);
+	}
+
+/**
+   set the assets of multiple actors from the string,
+   expects every line to be "ActorName AssetPath".
+
+   Returns the number of lines that could not be applied, 0 if all went fine.
+ */
+	FString SetActorAssetBatch(const TCHAR* Str)
+	{
+		TMap<FString, UObject*> AssetCache;
+		int32 NumFailed = 0;
+		FString Line;
+		while( FParse::Line(&Str, Line, 0) )
+		{
+			if( Line.IsEmpty() )
+				continue;
+			const TCHAR* LineStr = *Line;
+			const FString ActorName = FParse::Token(LineStr,0);
+			const FString AssetPath = FParse::Token(LineStr,0);
+			if( !SetActorAsset(ActorName, AssetPath, AssetCache) )
+			{
+				++NumFailed;
+			}
+		}
+		GEditor->RedrawLevelEditingViewports();
+		return FString::FromInt(NumFailed);
+	}
+};
+
+
 class Fm2uOpObjectParent : public Fm2uOperation
 {
 public:
@@ -592,6 +1108,11 @@ Fm2uOpObjectParent( Fm2uOperationManager* Manager = NULL )
 			Result = ParentChildTo(Str);
 		}
 
+		else if( FParse::Command(&Str, TEXT("ParentChildToBatch")))
+		{
+			Result = ParentChildToBatch(Str);
+		}
+
 		else
 		{
 // cannot handle the passed command
@@ -625,8 +1146,7 @@ Fm2uOpObjectParent( Fm2uOperationManager* Manager = NULL )
 			return TEXT("1");
 		}
 
-		// TODO: enable transaction?
-		//const FScopedTransaction Transaction( NSLOCTEXT("Editor", "UndoAction_PerformAttachment", "Attach actors") );
+		const FScopedTransaction Transaction( TEXT("m2u"), NSLOCTEXT("Editor", "UndoAction_PerformAttachment", "Attach actors"), NULL, m2uHelper::ShouldTransact() );
 
 		// parent to world, aka "detach"
 		if( ParentName.Len() < 1) // no valid parent name
@@ -662,4 +1182,172 @@ Fm2uOpObjectParent( Fm2uOperationManager* Manager = NULL )
 		return TEXT("0");
 	}
 
+/**
+   set up a whole hierarchy in one go, expects every line to be
+   "ChildName ParentName" or only "ChildName" to parent the child to the world.
+
+   All pairs are checked for cycles against the resulting hierarchy first, the
+   children that would be on a cycle are left untouched. Children whose
+   chain only leads into such a cycle are still parented.
+   Attaching and detaching is done on the components directly, instead of
+   through GEditor->ParentActors, which notifies the Editor for every single
+   Actor. The Editor is told about the changed hierarchy only once at the end.
+
+   Returns the number of lines that could not be applied, 0 if all went fine.
+ */
+	FString ParentChildToBatch(const TCHAR* Str)
+	{
+		// the desired parent for every child, NULL means the world
+		TArray<AActor*> Children;
+		TMap<AActor*, AActor*> NewParents;
+		int32 NumFailed = 0;
+
+		FString Line;
+		while( FParse::Line(&Str, Line, 0) )
+		{
+			if( Line.IsEmpty() )
+				continue;
+			const TCHAR* LineStr = *Line;
+			const FString ChildName = FParse::Token(LineStr,0);
+			const FString ParentName = FParse::Token(LineStr,0);
+
+			AActor* ChildActor = NULL;
+			if(!m2uHelper::GetActorByName(*ChildName, &ChildActor) || ChildActor == NULL
+			   || ChildActor->GetRootComponent() == NULL )
+			{
+				UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *ChildName);
+				++NumFailed;
+				continue;
+			}
+			AActor* ParentActor = NULL;
+			if( ParentName.Len() > 0 &&
+				(!m2uHelper::GetActorByName(*ParentName, &ParentActor) || ParentActor == NULL
+				 || ParentActor->GetRootComponent() == NULL) )
+			{
+				UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *ParentName);
+				++NumFailed;
+				continue;
+			}
+			if( !NewParents.Contains(ChildActor) )
+			{
+				Children.Add(ChildActor);
+			}
+			NewParents.Add(ChildActor, ParentActor);
+		}
+
+		// validate the resulting hierarchy, walk up from every child using the
+		// new parents where set, and the current ones otherwise. Actors that are
+		// known to end at the world are remembered, so every chain is walked once.
+		// Only the children that are on a cycle are rejected, not those whose
+		// chain merely leads into one. Without their new parents, the rest is
+		// walked again, until no cycle is left.
+		TSet<AActor*> Valid;
+		bool bFoundCycle = true;
+		while( bFoundCycle )
+		{
+			bFoundCycle = false;
+			for( AActor* Child : Children )
+			{
+				if( !NewParents.Contains(Child) )
+					continue; // rejected in this pass
+				TArray<AActor*> Path;
+				TMap<AActor*, int32> PathIndex;
+				int32 CycleStart = INDEX_NONE;
+				for( AActor* Actor = Child; Actor != NULL; )
+				{
+					if( Valid.Contains(Actor) )
+						break;
+					if( const int32* Index = PathIndex.Find(Actor) )
+					{
+						CycleStart = *Index;
+						break;
+					}
+					PathIndex.Add(Actor, Path.Add(Actor));
+					AActor** NewParent = NewParents.Find(Actor);
+					Actor = (NewParent != NULL) ? *NewParent : Actor->GetAttachParentActor();
+				}
+				if( CycleStart == INDEX_NONE )
+				{
+					Valid.Append(Path);
+					continue;
+				}
+				// the current hierarchy has no cycles, so at least one Actor
+				// on the cycle has a new parent
+				bFoundCycle = true;
+				for( int32 Idx = CycleStart; Idx < Path.Num(); ++Idx )
+				{
+					if( NewParents.Remove(Path[Idx]) > 0 )
+					{
+						UE_LOG(LogM2U, Log, TEXT("Parenting %s would create a cycle."), *Path[Idx]->GetName());
+						++NumFailed;
+					}
+				}
+			}
+			Children.RemoveAll( [&NewParents](AActor* Child){ return !NewParents.Contains(Child); } );
+		}
+
+		const FScopedTransaction Transaction( TEXT("m2u"), NSLOCTEXT("Editor", "UndoAction_PerformAttachment", "Attach actors"), NULL, m2uHelper::ShouldTransact() );
+		// detach every changing child first. Attaching in input order could
+		// form a temporary cycle when a parent and child swap places, which
+		// the Editor refuses.
+		TArray<AActor*> ToAttach;
+		for( AActor* ChildActor : Children )
+		{
+			AActor* ParentActor = NewParents.FindChecked(ChildActor);
+			USceneComponent* ChildRoot = ChildActor->GetRootComponent();
+			USceneComponent* OldParent = ChildRoot->GetAttachParent();
+			if( ParentActor != NULL && OldParent == ParentActor->GetRootComponent() )
+			{
+				continue;
+			}
+			if( OldParent != NULL )
+			{
+				ChildActor->Modify();
+				OldParent->GetOwner()->Modify();
+				ChildRoot->DetachFromParent(true);
+			}
+			if( ParentActor != NULL )
+			{
+				ToAttach.Add(ChildActor);
+			}
+		}
+
+		// attach parents before their children, by depth in the new hierarchy
+		TMap<AActor*, int32> Depths;
+		for( AActor* ChildActor : ToAttach )
+		{
+			int32 Depth = 0;
+			for( AActor* Actor = ChildActor; Actor != NULL; ++Depth )
+			{
+				AActor** NewParent = NewParents.Find(Actor);
+				Actor = (NewParent != NULL) ? *NewParent : Actor->GetAttachParentActor();
+			}
+			Depths.Add(ChildActor, Depth);
+		}
+		ToAttach.Sort( [&Depths](const AActor& A, const AActor& B)
+					   { return Depths.FindChecked(&A) < Depths.FindChecked(&B); } );
+
+		int32 NumAttached = 0;
+		for( AActor* ChildActor : ToAttach )
+		{
+			AActor* ParentActor = NewParents.FindChecked(ChildActor);
+			ChildActor->Modify();
+			ParentActor->Modify();
+			if( ChildActor->GetRootComponent()->AttachTo(ParentActor->GetRootComponent(), NAME_None, EAttachLocation::KeepWorldPosition) )
+			{
+				++NumAttached;
+			}
+			else
+			{
+				UE_LOG(LogM2U, Log, TEXT("Attaching %s to %s failed."), *ChildActor->GetName(), *ParentActor->GetName());
+				++NumFailed;
+			}
+		}
+
+		UE_LOG(LogM2U, Log, TEXT("Parented %i Actors, %i failed."), NumAttached, NumFailed);
+		GEngine->BroadcastLevelActorListChanged();
+		GEditor->RedrawLevelEditingViewports();
+		return FString::FromInt(NumFailed);
+	}
+
 };
@@ -0,0 +1,268 @@
+#pragma once
+// Operations to set and get properties of Actors and their components
+
+#include "m2uOperation.h"
+
+#include "ActorEditorUtils.h"
+#include "UnrealEd.h"
+#include "m2uHelper.h"
+#include "m2uPropertyHelper.h"
+
+
+class Fm2uOpProperty : public Fm2uOperation
+{
+public:
+
+	/** The status for each entry of a SetProperties command */
+	enum EStatus
+	{
+		Status_Ok = 0,
+		Status_ActorNotFound = 1,
+		Status_ComponentNotFound = 2,
+		Status_PropertyNotFound = 3,
+		Status_InvalidValue = 4
+	};
+
+	Fm2uOpProperty( Fm2uOperationManager* Manager = NULL )
+		:Fm2uOperation( Manager ){}
+
+	bool Execute( FString Cmd, FString& Result ) override
+	{
+		const TCHAR* Str = *Cmd;
+		bool DidExecute = true;
+
+		if( FParse::Command(&Str, TEXT("SetProperties")))
+		{
+			Result = SetProperties(Str);
+		}
+
+		else if( FParse::Command(&Str, TEXT("GetProperties")))
+		{
+			Result = GetProperties(Str);
+		}
+
+		else
+		{
+			// cannot handle the passed command
+			DidExecute = false;
+		}
+
+		if( DidExecute )
+			return true;
+		else
+			return false;
+	}
+
+/**
+   set many properties in one go, expects every line to be
+   "ActorName [Component:]Property.Path Value"
+   The Value is the rest of the line, in the text format the Editor uses for
+   copy & paste of properties, like "5000.0" or "(X=1.0,Y=2.0,Z=3.0)".
+
+   All values of one object are set between one PreEditChange/PostEditChange
+   pair, so every object only updates (reregisters, reruns construction
+   scripts and so on) once. The Actors owning changed components are told
+   as well, once per Actor, so construction scripts and details panels see
+   the change.
+
+   Returns a list of the status for each line [0,0,3,...] see EStatus.
+ */
+	FString SetProperties(const TCHAR* Str)
+	{
+		struct FEntry
+		{
+			UObject* Object;
+			const m2uPropertyHelper::FPropertyChain* Chain;
+			FString Value;
+		};
+		TArray<FEntry> Entries;
+		TArray<int32> Status;
+		// the entries of every object, in order of appearance
+		TArray<UObject*> Objects;
+		TMap<UObject*, TArray<int32> > ObjectEntries;
+
+		FString Line;
+		while( FParse::Line(&Str, Line, 0) )
+		{
+			if( Line.IsEmpty() )
+				continue;
+			const TCHAR* LineStr = *Line;
+			const FString ActorName = FParse::Token(LineStr,0);
+			const FString Target = FParse::Token(LineStr,0);
+			const int32 Idx = Status.Add(Status_Ok);
+			FEntry& Entry = Entries[ Entries.AddZeroed() ];
+			Entry.Value = FString(LineStr).Trim().TrimTrailing();
+
+			AActor* Actor = NULL;
+			if(!m2uHelper::GetActorByName(*ActorName, &Actor) || Actor == NULL)
+			{
+				Status[Idx] = Status_ActorNotFound;
+				continue;
+			}
+			FString ComponentName, PropertyPath;
+			m2uPropertyHelper::SplitTarget(Target, ComponentName, PropertyPath);
+			Entry.Object = m2uPropertyHelper::FindTargetObject(Actor, ComponentName);
+			if( Entry.Object == NULL )
+			{
+				Status[Idx] = Status_ComponentNotFound;
+				continue;
+			}
+			Entry.Chain = m2uPropertyHelper::ResolvePropertyPath(Entry.Object->GetClass(), PropertyPath);
+			if( Entry.Chain == NULL )
+			{
+				Status[Idx] = Status_PropertyNotFound;
+				continue;
+			}
+			if( !ObjectEntries.Contains(Entry.Object) )
+			{
+				Objects.Add(Entry.Object);
+			}
+			ObjectEntries.FindOrAdd(Entry.Object).Add(Idx);
+		}
+
+		// the Actors of changed components, in order of appearance
+		TArray<AActor*> Owners;
+		for( UObject* Object : Objects )
+		{
+			UActorComponent* Component = Cast<UActorComponent>(Object);
+			AActor* Owner = Component != NULL ? Component->GetOwner() : NULL;
+			if( Owner != NULL && !Owners.Contains(Owner) )
+			{
+				Owner->Modify();
+				Owners.Add(Owner);
+			}
+		}
+
+		for( UObject* Object : Objects )
+		{
+			const TArray<int32>& Indices = ObjectEntries.FindChecked(Object);
+
+			// tell the object which property changes, if it is only one
+			UProperty* ChangedProperty = (*Entries[Indices[0]].Chain)[0];
+			for( int32 Idx : Indices )
+			{
+				if( (*Entries[Idx].Chain)[0] != ChangedProperty )
+				{
+					ChangedProperty = NULL;
+					break;
+				}
+			}
+
+			Object->Modify();
+			Object->PreEditChange(ChangedProperty);
+			for( int32 Idx : Indices )
+			{
+				const FEntry& Entry = Entries[Idx];
+				UProperty* Property = Entry.Chain->Last();
+				void* ValuePtr = m2uPropertyHelper::GetValuePtr(*Entry.Chain, Object);
+				if( Property->ImportText(*Entry.Value, ValuePtr, PPF_None, Object) == NULL )
+				{
+					Status[Idx] = Status_InvalidValue;
+				}
+			}
+			FPropertyChangedEvent ChangedEvent(ChangedProperty);
+			Object->PostEditChangeProperty(ChangedEvent);
+			Object->MarkPackageDirty();
+		}
+		for( AActor* Owner : Owners )
+		{
+			Owner->PostEditChange();
+		}
+
+		UE_LOG(LogM2U, Log, TEXT("Set %i properties on %i objects."), Entries.Num(), Objects.Num());
+		GEditor->RedrawLevelEditingViewports();
+
+		TArray<FString> StatusStrings;
+		for( int32 Value : Status )
+		{
+			StatusStrings.Add(FString::FromInt(Value));
+		}
+		return FString(TEXT("[")) + FString::Join(StatusStrings, TEXT(",")) + TEXT("]");
+	}
+
+/**
+   get many properties of many Actors in one go.
+   GetProperties [Name1,Name2,...] Target1 Target2 ...
+   or
+   GetProperties Class=PointLight Target1 Target2 ...
+   to get the properties of all Actors of that class in the current level.
+   A Target is "[Component:]Property.Path" as for SetProperties.
+
+   The result is a table with one line per Actor, the columns separated by tabs.
+   The first line is the header "Name Target1 Target2 ...", every other line
+   is "ActorName Value1 Value2 ...", in the same text format as used by
+   SetProperties. Values that don't exist for an Actor are empty.
+ */
+	FString GetProperties(const TCHAR* Str)
+	{
+		const FString Selector = FParse::Token(Str,0);
+		TArray<FString> Targets;
+		FString Target;
+		while( FParse::Token(Str, Target, 0) )
+		{
+			Targets.Add(Target);
+		}
+		TArray<FString> ComponentNames, PropertyPaths;
+		ComponentNames.SetNum(Targets.Num());
+		PropertyPaths.SetNum(Targets.Num());
+		for( int32 Idx = 0; Idx < Targets.Num(); ++Idx )
+		{
+			m2uPropertyHelper::SplitTarget(Targets[Idx], ComponentNames[Idx], PropertyPaths[Idx]);
+		}
+
+		// find the Actors
+		TArray<AActor*> Actors;
+		FString ClassName;
+		if( FParse::Value(*Selector, TEXT("Class="), ClassName) )
+		{
+			UClass* Class = FindObject<UClass>(ANY_PACKAGE, *ClassName);
+			if( Class == NULL || !Class->IsChildOf(AActor::StaticClass()) )
+			{
+				UE_LOG(LogM2U, Log, TEXT("Actor class %s not found."), *ClassName);
+				return TEXT("1");
+			}
+			ULevel* Level = GEditor->GetEditorWorldContext().World()->GetCurrentLevel();
+			for( AActor* Actor : Level->Actors )
+			{
+				if( Actor != NULL && Actor->IsA(Class) )
+					Actors.Add(Actor);
+			}
+		}
+		else
+		{
+			for( const FString& ActorName : m2uHelper::ParseList(Selector) )
+			{
+				AActor* Actor = NULL;
+				if( m2uHelper::GetActorByName(*ActorName, &Actor) && Actor != NULL )
+					Actors.Add(Actor);
+			}
+		}
+
+		FString Table = TEXT("Name");
+		for( const FString& Column : Targets )
+		{
+			Table += TEXT("\t");
+			Table += Column;
+		}
+		for( AActor* Actor : Actors )
+		{
+			Table += TEXT("\n");
+			Table += Actor->GetName();
+			for( int32 Idx = 0; Idx < Targets.Num(); ++Idx )
+			{
+				Table += TEXT("\t");
+				UObject* Object = m2uPropertyHelper::FindTargetObject(Actor, ComponentNames[Idx]);
+				if( Object == NULL )
+					continue;
+				const m2uPropertyHelper::FPropertyChain* Chain =
+					m2uPropertyHelper::ResolvePropertyPath(Object->GetClass(), PropertyPaths[Idx]);
+				if( Chain == NULL )
+					continue;
+				const void* ValuePtr = m2uPropertyHelper::GetValuePtr(*Chain, Object);
+				// delimited, so strings are quoted and can't break the table
+				Chain->Last()->ExportTextItem(Table, ValuePtr, NULL, Object, PPF_Delimited);
+			}
+		}
+		return Table;
+	}
+};
@@ -0,0 +1,443 @@
+#pragma once
+// Load a whole scene from a binary scene package
+
+#include "m2uOperation.h"
+
+#include "ActorEditorUtils.h"
+#include "UnrealEd.h"
+#include "Engine/StreamableManager.h"
+#include "m2uHelper.h"
+#include "m2uAssetHelper.h"
+#include "m2uOpObject.h"
+
+
+/**
+   The scene package is the fast path for the initial transfer of a scene. All
+   values are little-endian, all sections are 4-byte aligned:
+
+   Header:
+     char   Magic[4]        "M2US"
+     uint32 Version         1
+     uint32 NumStrings
+     uint32 NumAssets
+     uint32 NumActors
+     uint32 StringDataSize  in bytes, without padding
+   String table:
+     uint32 Offsets[NumStrings]      into the string data
+     uint8  StringData[StringDataSize]  UTF-8, every string null-terminated,
+                                        padded with zeros to 4 bytes
+   Asset table:
+     uint32 AssetPath[NumAssets]     string index, "/Game/Meshes/MyMesh"
+   Actor records (m2uScenePackage::FActorRecord):
+     uint32 Asset     index into the asset table
+     uint32 Name      string index
+     uint32 Parent    index of an earlier actor record, or 0xFFFFFFFF
+     float  Rotation[4], Location[3], Scale[3]  relative to the parent
+
+   Transforms are expected in Editor space, the Program has to convert them.
+ */
+namespace m2uScenePackage
+{
+	const uint32 Version = 1;
+	const uint32 NoParent = 0xFFFFFFFF;
+
+	struct FHeader
+	{
+		uint8 Magic[4];
+		uint32 Version;
+		uint32 NumStrings;
+		uint32 NumAssets;
+		uint32 NumActors;
+		uint32 StringDataSize;
+	};
+
+	struct FActorRecord
+	{
+		uint32 Asset;
+		uint32 Name;
+		uint32 Parent;
+		float Rotation[4];
+		float Location[3];
+		float Scale[3];
+	};
+
+	static_assert( sizeof(FHeader) == 24, "scene package header must be 24 bytes" );
+	static_assert( sizeof(FActorRecord) == 52, "scene package actor record must be 52 bytes" );
+}
+
+
+class Fm2uOpScenePackage : public Fm2uOperation
+{
+public:
+
+	enum class EPhase : uint8
+	{
+		Idle,
+		Loading,
+		Spawning
+	};
+
+Fm2uOpScenePackage( Fm2uOperationManager* Manager = NULL )
+	:Fm2uOperation( Manager ),
+	 Phase( EPhase::Idle ),
+	 LoadId( 0 ),
+	 TimeBudget( 0.01 ),
+	 StartTime( 0.0 ),
+	 NextActor( 0 ),
+	 NumSpawned( 0 ),
+	 Strings( NULL ),
+	 StringData( NULL ),
+	 AssetTable( NULL ),
+	 Records( NULL )
+	{}
+
+	bool Execute( FString Cmd, FString& Result ) override
+	{
+		const TCHAR* Str = *Cmd;
+		bool DidExecute = true;
+
+		/* LoadScenePackage <Filename> [BudgetMs=10]
+		   Load the package, preload all assets asynchronously and spawn the
+		   actors spending at most BudgetMs every tick. Poll
+		   GetScenePackageStatus to know when it is done. */
+		if( FParse::Command(&Str, TEXT("LoadScenePackage")))
+		{
+			const FString Filename = FParse::Token(Str, 0);
+			float BudgetMs = 10.0f;
+			FParse::Value(Str, TEXT("BudgetMs="), BudgetMs);
+			Result = Load( Filename, BudgetMs / 1000.0 );
+		}
+
+		else if( FParse::Command(&Str, TEXT("CancelScenePackage")))
+		{
+			if( Phase != EPhase::Idle )
+			{
+				UE_LOG(LogM2U, Warning, TEXT("Cancelled scene package %s (%s)."), *Filename, *GetStatus());
+				LastResult = FString::Printf(TEXT("Cancelled %s"), *Filename);
+				Close();
+			}
+			Result = TEXT("Ok");
+		}
+
+		else if( FParse::Command(&Str, TEXT("GetScenePackageStatus")))
+		{
+			Result = GetStatus();
+		}
+
+		else
+		{
+// cannot handle the passed command
+			DidExecute = false;
+		}
+
+		if( DidExecute )
+			return true;
+		else
+			return false;
+	}
+
+	void Tick( float DeltaTime ) override
+	{
+		if( Phase != EPhase::Spawning )
+		{
+			return;
+		}
+
+		UWorld* World = GEditor->GetEditorWorldContext().World();
+		ULevel* Level = World->GetCurrentLevel();
+		const double TickStart = FPlatformTime::Seconds();
+		const int32 NumActors = SpawnedActors.Num();
+		while( NextActor < NumActors )
+		{
+			SpawnActor( NextActor, Level );
+			++NextActor;
+			if( TimeBudget > 0.0 && FPlatformTime::Seconds() - TickStart >= TimeBudget )
+			{
+				break;
+			}
+		}
+
+		if( NextActor == NumActors )
+		{
+			FinishSpawning();
+		}
+	}
+
+	/**
+	 * Read the package and start the asynchronous loading of the assets.
+	 * Returns "Ok" or what went wrong.
+	 */
+	FString Load( const FString& InFilename, double Budget )
+	{
+		if( Phase != EPhase::Idle )
+		{
+			UE_LOG(LogM2U, Warning, TEXT("Cancelled scene package %s, loading %s."), *Filename, *InFilename);
+			Close();
+		}
+		LastResult.Empty();
+
+		// the file is read in one go, everything else is read in place
+		if( ! FFileHelper::LoadFileToArray(PackageData, *InFilename) )
+		{
+			return FString::Printf(TEXT("File %s not found"), *InFilename);
+		}
+		const FString Error = Validate();
+		if( ! Error.IsEmpty() )
+		{
+			Close();
+			UE_LOG(LogM2U, Error, TEXT("Invalid scene package %s: %s"), *InFilename, *Error);
+			return Error;
+		}
+
+		Filename = InFilename;
+		TimeBudget = Budget;
+		StartTime = FPlatformTime::Seconds();
+		NextActor = NumSpawned = 0;
+		SpawnedActors.SetNum( Header()->NumActors );
+
+		TArray<FStringAssetReference> AssetRefs;
+		for( uint32 Idx = 0; Idx < Header()->NumAssets; ++Idx )
+		{
+			const FString ObjectPath = m2uAssetHelper::GetObjectPathFromAssetPath( GetString(AssetTable[Idx]) );
+			AssetRefs.Add( FStringAssetReference(ObjectPath) );
+		}
+		LoadedAssetRefs = AssetRefs;
+		Phase = EPhase::Loading;
+		UE_LOG(LogM2U, Log, TEXT("Loading scene package %s: %i assets, %i actors."),
+			   *Filename, Header()->NumAssets, Header()->NumActors);
+		// the id makes sure a cancelled load doesn't continue when its
+		// assets arrive later
+		StreamableManager.RequestAsyncLoad( AssetRefs,
+			FStreamableDelegate::CreateRaw(this, &Fm2uOpScenePackage::OnAssetsLoaded, ++LoadId) );
+		return TEXT("Ok");
+	}
+
+	bool IsBusy() const override
+	{
+		return Phase != EPhase::Idle;
+	}
+
+	/**
+	 * "<Filename> Loading" or "<Filename> Spawning <Spawned>/<Total>" while
+	 * busy. Otherwise the outcome of the last package, "Done <Filename>
+	 * <Spawned>/<Total>" or "Cancelled <Filename>", or "Idle" if there was none.
+	 */
+	FString GetStatus() const
+	{
+		switch( Phase )
+		{
+		case EPhase::Loading:
+			return Filename + TEXT(" Loading");
+		case EPhase::Spawning:
+			return FString::Printf(TEXT("%s Spawning %i/%i"), *Filename, NextActor, SpawnedActors.Num());
+		default:
+			return LastResult.IsEmpty() ? FString(TEXT("Idle")) : LastResult;
+		}
+	}
+
+protected:
+
+	const m2uScenePackage::FHeader* Header() const
+	{
+		return (const m2uScenePackage::FHeader*)PackageData.GetData();
+	}
+
+	FString GetString( uint32 Index ) const
+	{
+		return UTF8_TO_TCHAR( (const ANSICHAR*)(StringData + Strings[Index]) );
+	}
+
+	/**
+	 * Check the package data and set up the pointers to the sections.
+	 * After this, all indices and offsets in the package can be trusted.
+	 * Returns what is wrong, or an empty string.
+	 */
+	FString Validate()
+	{
+		using namespace m2uScenePackage;
+		const int64 Size = PackageData.Num();
+		if( Size < (int64)sizeof(FHeader) || FMemory::Memcmp(Header()->Magic, "M2US", 4) != 0 )
+		{
+			return TEXT("Not a scene package");
+		}
+		const FHeader& H = *Header();
+		if( H.Version != Version )
+		{
+			return FString::Printf(TEXT("Unsupported version %u"), H.Version);
+		}
+
+		const int64 StringsOffset = sizeof(FHeader);
+		const int64 StringDataOffset = StringsOffset + 4 * (int64)H.NumStrings;
+		const int64 AssetsOffset = StringDataOffset + Align( (int64)H.StringDataSize, 4 );
+		const int64 RecordsOffset = AssetsOffset + 4 * (int64)H.NumAssets;
+		const int64 EndOffset = RecordsOffset + sizeof(FActorRecord) * (int64)H.NumActors;
+		if( EndOffset > Size )
+		{
+			return TEXT("File is truncated");
+		}
+
+		const uint8* Data = PackageData.GetData();
+		Strings = (const uint32*)(Data + StringsOffset);
+		StringData = Data + StringDataOffset;
+		AssetTable = (const uint32*)(Data + AssetsOffset);
+		Records = (const FActorRecord*)(Data + RecordsOffset);
+
+		if( H.StringDataSize == 0 || StringData[H.StringDataSize - 1] != 0 )
+		{
+			return TEXT("String data is not terminated");
+		}
+		for( uint32 Idx = 0; Idx < H.NumStrings; ++Idx )
+		{
+			if( Strings[Idx] >= H.StringDataSize )
+				return FString::Printf(TEXT("String %u out of range"), Idx);
+		}
+		for( uint32 Idx = 0; Idx < H.NumAssets; ++Idx )
+		{
+			if( AssetTable[Idx] >= H.NumStrings )
+				return FString::Printf(TEXT("Asset %u has an invalid path"), Idx);
+		}
+		for( uint32 Idx = 0; Idx < H.NumActors; ++Idx )
+		{
+			const FActorRecord& Record = Records[Idx];
+			if( Record.Asset >= H.NumAssets || Record.Name >= H.NumStrings )
+				return FString::Printf(TEXT("Actor %u has an invalid asset or name"), Idx);
+			// parents before children, so there can't be cycles
+			if( Record.Parent != NoParent && Record.Parent >= Idx )
+				return FString::Printf(TEXT("Actor %u has an invalid parent"), Idx);
+		}
+		return FString();
+	}
+
+	void OnAssetsLoaded( int32 Id )
+	{
+		if( Id != LoadId || Phase != EPhase::Loading )
+		{
+			return;
+		}
+		Assets.SetNum( Header()->NumAssets );
+		for( uint32 Idx = 0; Idx < Header()->NumAssets; ++Idx )
+		{
+			Assets[Idx] = LoadedAssetRefs[Idx].ResolveObject();
+			if( Assets[Idx] == NULL )
+			{
+				UE_LOG(LogM2U, Warning, TEXT("Failed to load Asset %s."), *LoadedAssetRefs[Idx].ToString());
+			}
+		}
+		UE_LOG(LogM2U, Log, TEXT("Scene package assets loaded after %.2f seconds."),
+			   FPlatformTime::Seconds() - StartTime);
+		Phase = EPhase::Spawning;
+	}
+
+	void SpawnActor( int32 Idx, ULevel* Level )
+	{
+		const m2uScenePackage::FActorRecord& Record = Records[Idx];
+		UObject* Asset = Assets[Record.Asset];
+		if( Asset == NULL )
+		{
+			return;
+		}
+		const FName Name( *GetString(Record.Name) );
+		AActor* Actor = Adder.AddNewActorFromAsset( Asset, Level, Name, false );
+		if( Actor == NULL || Actor->GetRootComponent() == NULL )
+		{
+			UE_LOG(LogM2U, Warning, TEXT("Failed to spawn %s."), *Name.ToString());
+			return;
+		}
+		SpawnedActors[Idx] = Actor;
+		++NumSpawned;
+	}
+
+	/**
+	 * Build the hierarchy and set all transforms in one batch, so every
+	 * hierarchy is updated only once.
+	 */
+	void FinishSpawning()
+	{
+		TArray<AActor*> Actors;
+		TArray<m2uHelper::Fm2uTransformInput> Inputs;
+		Actors.Reserve( NumSpawned );
+		Inputs.Reserve( NumSpawned );
+		for( int32 Idx = 0; Idx < SpawnedActors.Num(); ++Idx )
+		{
+			AActor* Actor = SpawnedActors[Idx].Get();
+			if( Actor == NULL )
+			{
+				continue;
+			}
+			const m2uScenePackage::FActorRecord& Record = Records[Idx];
+			if( Record.Parent != m2uScenePackage::NoParent )
+			{
+				AActor* Parent = SpawnedActors[Record.Parent].Get();
+				if( Parent != NULL )
+				{
+					Actor->GetRootComponent()->AttachTo( Parent->GetRootComponent(), NAME_None,
+														 EAttachLocation::KeepRelativeOffset );
+				}
+			}
+
+			m2uHelper::Fm2uTransformInput Input;
+			Input.SetFromTransform( FTransform(
+				FQuat(Record.Rotation[0], Record.Rotation[1], Record.Rotation[2], Record.Rotation[3]),
+				FVector(Record.Location[0], Record.Location[1], Record.Location[2]),
+				FVector(Record.Scale[0], Record.Scale[1], Record.Scale[2]) ) );
+			Actors.Add( Actor );
+			Inputs.Add( Input );
+		}
+		m2uHelper::SetActorTransformsBatch( Actors, Inputs );
+
+		GEngine->BroadcastLevelActorListChanged();
+		GEditor->RedrawLevelEditingViewports();
+
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		UE_LOG(LogM2U, Log, TEXT("Loaded scene package %s: spawned %i of %i actors in %.2f seconds (%.0f actors/s)."),
+			   *Filename, NumSpawned, SpawnedActors.Num(), Seconds, Seconds > 0.0 ? NumSpawned / Seconds : 0.0);
+		LastResult = FString::Printf(TEXT("Done %s %i/%i"), *Filename, NumSpawned, SpawnedActors.Num());
+		Close();
+	}
+
+	void Close()
+	{
+		for( const FStringAssetReference& Ref : LoadedAssetRefs )
+		{
+			StreamableManager.Unload( Ref );
+		}
+		LoadedAssetRefs.Empty();
+		Assets.Empty();
+		SpawnedActors.Empty();
+		PackageData.Empty();
+		Strings = NULL;
+		StringData = NULL;
+		AssetTable = NULL;
+		Records = NULL;
+		Phase = EPhase::Idle;
+	}
+
+protected:
+
+	EPhase Phase;
+	/** incremented for every load, see OnAssetsLoaded */
+	int32 LoadId;
+	FString Filename;
+	/** what the last package ended with, see GetStatus */
+	FString LastResult;
+	double TimeBudget;
+	double StartTime;
+	int32 NextActor;
+	int32 NumSpawned;
+
+	/** the whole package, the pointers below point into it */
+	TArray<uint8> PackageData;
+	const uint32* Strings;
+	const uint8* StringData;
+	const uint32* AssetTable;
+	const m2uScenePackage::FActorRecord* Records;
+
+	/** keeps the loaded assets referenced until the actors are spawned */
+	FStreamableManager StreamableManager;
+	TArray<FStringAssetReference> LoadedAssetRefs;
+	TArray<UObject*> Assets;
+	TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+
+	/** used for spawning, not registered with the manager */
+	Fm2uOpObjectAdd Adder;
+};
@@ -5,6 +5,7 @@
 
 #include "ActorEditorUtils.h"
 #include "UnrealEd.h"
+#include "m2uHelper.h"
 
 class Fm2uOpSelection : public Fm2uOperation
 {
@@ -21,15 +22,7 @@ Fm2uOpSelection( Fm2uOperationManager* Manager = NULL )
 		if( FParse::Command(&Str, TEXT("SelectByNames")))
 		{
 			FString ActorNamesList = FParse::Token(Str,0);
-			TArray<FString> ActorNames = m2uHelper::ParseList(ActorNamesList);			
-			for( FString ActorName : ActorNames )
-			{
-				AActor* Actor;
-				if( m2uHelper::GetActorByName(*ActorName, &Actor) )
-				{
-					GEditor->SelectActor( Actor, true, true, true);// actor, select, notify, evenIfHidden
-				}			   
-			}
+			SetSelected( ResolveActors(ActorNamesList), true );
 			GEditor->RedrawLevelEditingViewports();
 			DidExecute = true;
 		}
@@ -44,36 +37,248 @@ Fm2uOpSelection( Fm2uOperationManager* Manager = NULL )
 
 		else if( FParse::Command(&Str, TEXT("DeselectByNames")))
 		{
-			TArray<AActor*> SelectedActors;
-			USelection* Selection = GEditor->GetSelectedActors();
-			Selection->GetSelectedObjects<AActor>(SelectedActors);
-			
 			FString ActorNamesList = FParse::Token(Str,0);
-			TArray<FString> ActorNames = m2uHelper::ParseList(ActorNamesList);			
-			for( FString ActorName : ActorNames )
+			SetSelected( ResolveActors(ActorNamesList), false );
+			GEditor->RedrawLevelEditingViewports();
+			DidExecute = true;
+		}
+
+		else if( FParse::Command(&Str, TEXT("StoreSelectionSet")))
+		{
+			const FString SetName = FParse::Token(Str,0);
+			TArray<AActor*> SelectedActors;
+			GEditor->GetSelectedActors()->GetSelectedObjects<AActor>(SelectedActors);
+			TArray< TWeakObjectPtr<AActor> >& Set = SelectionSets.FindOrAdd(SetName);
+			Set.Empty(SelectedActors.Num());
+			for( AActor* Actor : SelectedActors )
 			{
-				for( int32 Idx = 0 ; Idx < SelectedActors.Num() ; ++Idx )
-				{
-					AActor* Actor = SelectedActors[ Idx ];
-					if(Actor->GetFName().ToString() == ActorName)
-					{
-						Selection->Modify();
-						//Selection->BeginBatchSelectOperation();
-						//Selection->Deselect(Actor);
-						//Selection->EndBatchSelectOperation();
-						GEditor->SelectActor( Actor, false, true, true ); // deselect
-						break;
-					}
-				}	
+				Set.Add(Actor);
 			}
+			DidExecute = true;
+		}
+
+		else if( FParse::Command(&Str, TEXT("RestoreSelectionSet")))
+		{
+			const FString SetName = FParse::Token(Str,0);
+			const TArray< TWeakObjectPtr<AActor> >* Set = SelectionSets.Find(SetName);
+			if( Set == NULL )
+			{
+				Result = TEXT("1");
+				return true;
+			}
+			ReplaceSelection( ToActorSet(*Set) );
 			GEditor->RedrawLevelEditingViewports();
 			DidExecute = true;
 		}
 
+		else if( FParse::Command(&Str, TEXT("DeleteSelectionSet")))
+		{
+			const FString SetName = FParse::Token(Str,0);
+			SelectionSets.Remove(SetName);
+			DidExecute = true;
+		}
+
+		else if( FParse::Command(&Str, TEXT("CombineSelectionSets")))
+		{
+			const FString Mode = FParse::Token(Str,0);
+			const FString NameA = FParse::Token(Str,0);
+			const FString NameB = FParse::Token(Str,0);
+			const FString ResultName = FParse::Token(Str,0);
+			Result = CombineSelectionSets(Mode, NameA, NameB, ResultName);
+			return true;
+		}
+
+		else if( FParse::Command(&Str, TEXT("GetSelectionSets")))
+		{
+			TArray<FString> SetNames;
+			SelectionSets.GetKeys(SetNames);
+			Result = FString(TEXT("[")) + FString::Join(SetNames, TEXT(",")) + TEXT("]");
+			return true;
+		}
+
 		Result = TEXT("Ok");
 		if( DidExecute )
 			return true;
 		else
 			return false;
 	}
+
+	/**
+	   find all Actors of the names list, every Actor will be in the result only once
+	*/
+	TSet<AActor*> ResolveActors( const FString& ActorNamesList )
+	{
+		TSet<AActor*> Actors;
+		for( const FString& ActorName : m2uHelper::ParseList(ActorNamesList) )
+		{
+			AActor* Actor;
+			if( m2uHelper::GetActorByName(*ActorName, &Actor) )
+			{
+				Actors.Add(Actor);
+			}
+		}
+		return Actors;
+	}
+
+	/**
+	   select or deselect all the Actors.
+	   The changes are done in one batch select operation and only one
+	   selection-change notification is sent at the end, as the Editor does
+	   for its own "select all" and so on. Nothing is sent if nothing changed.
+	*/
+	void SetSelected( const TSet<AActor*>& Actors, bool bSelect )
+	{
+		TArray<AActor*> Changed;
+		for( AActor* Actor : Actors )
+		{
+			if( Actor->IsSelected() != bSelect )
+			{
+				Changed.Add( Actor );
+			}
+		}
+		if( Changed.Num() == 0 )
+		{
+			return;
+		}
+
+		USelection* Selection = GEditor->GetSelectedActors();
+		Selection->BeginBatchSelectOperation();
+		Selection->Modify();
+		for( AActor* Actor : Changed )
+		{
+			GEditor->SelectActor( Actor, bSelect, false, true );// actor, select, notify, evenIfHidden
+		}
+		// NoteSelectionChange does the one broadcast
+		Selection->EndBatchSelectOperation( false );
+		GEditor->NoteSelectionChange();
+	}
+
+	/**
+	   make the Actors the only selected ones, in one batch select operation.
+	*/
+	void ReplaceSelection( const TSet<AActor*>& Actors )
+	{
+		TArray<AActor*> SelectedActors;
+		USelection* Selection = GEditor->GetSelectedActors();
+		Selection->GetSelectedObjects<AActor>(SelectedActors);
+
+		TArray<AActor*> ToDeselect;
+		for( AActor* Actor : SelectedActors )
+		{
+			if( !Actors.Contains(Actor) )
+			{
+				ToDeselect.Add( Actor );
+			}
+		}
+		TArray<AActor*> ToSelect;
+		for( AActor* Actor : Actors )
+		{
+			if( !Actor->IsSelected() )
+			{
+				ToSelect.Add( Actor );
+			}
+		}
+		if( ToDeselect.Num() == 0 && ToSelect.Num() == 0 )
+		{
+			return;
+		}
+
+		Selection->BeginBatchSelectOperation();
+		Selection->Modify();
+		for( AActor* Actor : ToDeselect )
+		{
+			GEditor->SelectActor( Actor, false, false, true );
+		}
+		for( AActor* Actor : ToSelect )
+		{
+			GEditor->SelectActor( Actor, true, false, true );
+		}
+		// NoteSelectionChange does the one broadcast
+		Selection->EndBatchSelectOperation( false );
+		GEditor->NoteSelectionChange();
+	}
+
+	/**
+	   get the Actors of a selection set that still exist
+	*/
+	TSet<AActor*> ToActorSet( const TArray< TWeakObjectPtr<AActor> >& Set )
+	{
+		TSet<AActor*> Actors;
+		for( const TWeakObjectPtr<AActor>& Actor : Set )
+		{
+			if( Actor.IsValid() )
+			{
+				Actors.Add( Actor.Get() );
+			}
+		}
+		return Actors;
+	}
+
+	/**
+	   combine two selection sets into a (new) third one.
+	   Mode is Union, Difference (A without B) or Intersection.
+	   A set name of "Selection" refers to the current selection.
+	*/
+	FString CombineSelectionSets( const FString& Mode, const FString& NameA,
+								  const FString& NameB, const FString& ResultName )
+	{
+		TSet<AActor*> SetA, SetB;
+		if( !GetNamedSet(NameA, SetA) || !GetNamedSet(NameB, SetB) )
+		{
+			return TEXT("1");
+		}
+
+		TSet<AActor*> Combined;
+		if( Mode == TEXT("Union") )
+			Combined = SetA.Union(SetB);
+		else if( Mode == TEXT("Difference") )
+			Combined = SetA.Difference(SetB);
+		else if( Mode == TEXT("Intersection") )
+			Combined = SetA.Intersect(SetB);
+		else
+			return TEXT("1");
+
+		if( ResultName == TEXT("Selection") )
+		{
+			ReplaceSelection( Combined );
+			GEditor->RedrawLevelEditingViewports();
+			return TEXT("Ok");
+		}
+		TArray< TWeakObjectPtr<AActor> >& Set = SelectionSets.FindOrAdd(ResultName);
+		Set.Empty(Combined.Num());
+		for( AActor* Actor : Combined )
+		{
+			Set.Add(Actor);
+		}
+		return TEXT("Ok");
+	}
+
+	/**
+	   get the Actors of the named selection set, or the current selection
+	*/
+	bool GetNamedSet( const FString& SetName, TSet<AActor*>& OutActors )
+	{
+		if( SetName == TEXT("Selection") )
+		{
+			TArray<AActor*> SelectedActors;
+			GEditor->GetSelectedActors()->GetSelectedObjects<AActor>(SelectedActors);
+			OutActors.Append(SelectedActors);
+			return true;
+		}
+		const TArray< TWeakObjectPtr<AActor> >* Set = SelectionSets.Find(SetName);
+		if( Set == NULL )
+		{
+			return false;
+		}
+		OutActors = ToActorSet(*Set);
+		return true;
+	}
+
+protected:
+
+	/**
+	   named selection sets, stored in the plugin, so switching between big
+	   selections doesn't require sending all the names every time.
+	*/
+	TMap< FString, TArray< TWeakObjectPtr<AActor> > > SelectionSets;
 };
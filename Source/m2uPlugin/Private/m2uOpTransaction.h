@@ -5,6 +5,7 @@
 
 #include "ActorEditorUtils.h"
 #include "UnrealEd.h"
+#include "Editor/TransBuffer.h"
 #include "m2uHelper.h"
 
 
@@ -13,7 +14,35 @@ class Fm2uOpTransaction : public Fm2uOperation
 public:
 
 Fm2uOpTransaction( Fm2uOperationManager* Manager = NULL )
-	:Fm2uOperation( Manager ){}
+	:Fm2uOperation( Manager ),
+	 BatchDepth( 0 ),
+	 bBatchTransacting( false ),
+	 MaxBytes( 256 * 1024 * 1024 ),
+	 TimeSinceTrim( 0.0f ){}
+
+	~Fm2uOpTransaction()
+	{
+		// don't leave a transaction open
+		if( bBatchTransacting && GEditor != NULL )
+		{
+			GEditor->EndTransaction();
+		}
+	}
+
+	/** a batch the Program didn't end would stay open forever */
+	void OnClientDisconnected() override
+	{
+		if( BatchDepth > 0 )
+		{
+			UE_LOG(LogM2U, Warning, TEXT("Client disconnected inside a batch, ending %i open batch levels."), BatchDepth);
+		}
+		BatchDepth = 0;
+		if( bBatchTransacting )
+		{
+			GEditor->EndTransaction();
+			bBatchTransacting = false;
+		}
+	}
 
 	bool Execute( FString Cmd, FString& Result ) override
 	{
@@ -32,6 +61,93 @@ Fm2uOpTransaction( Fm2uOperationManager* Manager = NULL )
 			Result = TEXT("Ok");
 		}
 
+		/* Everything between BeginBatch and EndBatch goes into one undo
+		   transaction, so a whole sync can be undone in one step, and there
+		   is no transaction overhead for every single command.
+		   Transactions of single commands inside the batch are merged into
+		   the batch transaction. Batches may be nested.
+		   The transaction stays open across editor ticks until EndBatch, so
+		   keep batches short: edits the user makes meanwhile are merged into
+		   it too, and Undo and the Capped trimming can't run. A batch is
+		   not started while another transaction is active, the result is
+		   "Transaction active" then and the matching EndBatch does nothing. */
+		else if( FParse::Command(&Str, TEXT("BeginBatch")))
+		{
+			if( BatchDepth == 0 && GEditor->IsTransactionActive() )
+			{
+				UE_LOG(LogM2U, Warning, TEXT("BeginBatch refused, another transaction is active."));
+				Result = TEXT("Transaction active");
+				return true;
+			}
+			if( BatchDepth == 0 && m2uHelper::ShouldTransact() )
+			{
+				FString Description = TEXT("m2u Sync");
+				FParse::Value(Str, TEXT("Description="), Description);
+				GEditor->BeginTransaction( TEXT("m2u"), FText::FromString(Description), NULL );
+				bBatchTransacting = true;
+			}
+			++BatchDepth;
+			Result = TEXT("Ok");
+		}
+
+		else if( FParse::Command(&Str, TEXT("EndBatch")))
+		{
+			if( BatchDepth > 0 && --BatchDepth == 0 && bBatchTransacting )
+			{
+				GEditor->EndTransaction();
+				bBatchTransacting = false;
+			}
+			Result = TEXT("Ok");
+		}
+
+		/* Set how m2u uses the transaction buffer, see m2uHelper::Em2uTransactionMode.
+		   SetTransactionMode Normal|Off|Capped [MaxMB=256]
+		   In Capped mode, the m2u transactions are trimmed to MaxMB regularly. */
+		else if( FParse::Command(&Str, TEXT("SetTransactionMode")))
+		{
+			const FString Mode = FParse::Token(Str, 0);
+			int32 MaxMB = 0;
+			if( FParse::Value(Str, TEXT("MaxMB="), MaxMB) )
+			{
+				MaxBytes = (SIZE_T)FMath::Max(MaxMB, 0) * 1024 * 1024;
+			}
+
+			if( Mode == TEXT("Normal") )
+				m2uHelper::GetTransactionMode() = m2uHelper::Em2uTransactionMode::Normal;
+			else if( Mode == TEXT("Off") )
+				m2uHelper::GetTransactionMode() = m2uHelper::Em2uTransactionMode::Off;
+			else if( Mode == TEXT("Capped") )
+				m2uHelper::GetTransactionMode() = m2uHelper::Em2uTransactionMode::Capped;
+			else
+			{
+				Result = FString::Printf(TEXT("Unknown transaction mode %s"), *Mode);
+				return true;
+			}
+			TimeSinceTrim = 0.0f;
+			Result = TEXT("Ok");
+		}
+
+		/* Report the transaction buffer memory:
+		   "m2uCount m2uBytes TotalCount TotalBytes" */
+		else if( FParse::Command(&Str, TEXT("GetTransactionMemory")))
+		{
+			int32 Count = 0, M2uCount = 0;
+			SIZE_T Bytes = 0, M2uBytes = 0;
+			GetTransactionMemory( Count, Bytes, M2uCount, M2uBytes );
+			Result = FString::Printf(TEXT("%d %llu %d %llu"), M2uCount, (uint64)M2uBytes, Count, (uint64)Bytes);
+		}
+
+		/* Trim the oldest m2u undo entries until they use no more than MaxMB.
+		   Only m2u entries in front of the oldest user entry are removed,
+		   without MaxMB all of them. Returns the number of removed entries. */
+		else if( FParse::Command(&Str, TEXT("TrimTransactions")))
+		{
+			int32 MaxMB = 0;
+			FParse::Value(Str, TEXT("MaxMB="), MaxMB);
+			const int32 Removed = TrimTransactions( (SIZE_T)FMath::Max(MaxMB, 0) * 1024 * 1024 );
+			Result = FString::FromInt(Removed);
+		}
+
 		else
 		{
 // cannot handle the passed command
@@ -43,4 +159,115 @@ Fm2uOpTransaction( Fm2uOperationManager* Manager = NULL )
 		else
 			return false;
 	}
+
+	void Tick( float DeltaTime ) override
+	{
+		if( m2uHelper::GetTransactionMode() != m2uHelper::Em2uTransactionMode::Capped )
+		{
+			return;
+		}
+		// measuring walks all the transaction records, so don't do it every frame
+		TimeSinceTrim += DeltaTime;
+		if( TimeSinceTrim < 1.0f )
+		{
+			return;
+		}
+		TimeSinceTrim = 0.0f;
+		TrimTransactions( MaxBytes );
+	}
+
+	/**
+	 * Sum up the size of the undo entries, total and of those created by m2u
+	 * (transactions with the "m2u" context).
+	 */
+	void GetTransactionMemory( int32& OutCount, SIZE_T& OutBytes,
+							   int32& OutM2uCount, SIZE_T& OutM2uBytes )
+	{
+		OutCount = OutM2uCount = 0;
+		OutBytes = OutM2uBytes = 0;
+		UTransBuffer* Buffer = GEditor ? Cast<UTransBuffer>(GEditor->Trans) : NULL;
+		if( Buffer == NULL )
+		{
+			return;
+		}
+		for( const FTransaction& Transaction : Buffer->UndoBuffer )
+		{
+			const SIZE_T Size = Transaction.DataSize();
+			OutCount++;
+			OutBytes += Size;
+			if( Transaction.GetContext().Context == TEXT("m2u") )
+			{
+				OutM2uCount++;
+				OutM2uBytes += Size;
+			}
+		}
+	}
+
+	/**
+	 * Remove the oldest m2u transactions until they use no more than
+	 * MaxM2uBytes, like a ring buffer.
+	 * Only the run of m2u transactions at the front (the oldest end) is
+	 * removed, it stops at the first entry that wasn't created by m2u. Later
+	 * entries may depend on what an m2u transaction spawned or deleted, so
+	 * removing one out of the middle would make undoing past the gap leave
+	 * the level inconsistent. User entries are never removed, and neither
+	 * are entries that can be redone or an active transaction.
+	 * The undo history UI is told about the change.
+	 * Returns the number of removed entries.
+	 */
+	int32 TrimTransactions( SIZE_T MaxM2uBytes )
+	{
+		UTransBuffer* Buffer = GEditor ? Cast<UTransBuffer>(GEditor->Trans) : NULL;
+		if( Buffer == NULL || GEditor->IsTransactionActive() )
+		{
+			return 0;
+		}
+
+		SIZE_T M2uBytes = 0;
+		for( const FTransaction& Transaction : Buffer->UndoBuffer )
+		{
+			if( Transaction.GetContext().Context == TEXT("m2u") )
+			{
+				M2uBytes += Transaction.DataSize();
+			}
+		}
+
+		// the last UndoCount entries are undone and may be redone
+		const int32 Trimmable = Buffer->UndoBuffer.Num() - Buffer->UndoCount;
+		int32 NumRemove = 0;
+		while( M2uBytes > MaxM2uBytes && NumRemove < Trimmable )
+		{
+			const FTransaction& Transaction = Buffer->UndoBuffer[NumRemove];
+			if( Transaction.GetContext().Context != TEXT("m2u") )
+			{
+				break;
+			}
+			M2uBytes -= Transaction.DataSize();
+			NumRemove++;
+		}
+
+		if( NumRemove > 0 )
+		{
+			Buffer->UndoBuffer.RemoveAt( 0, NumRemove );
+			Buffer->OnUndoBufferChanged().Broadcast();
+			UE_LOG(LogM2U, Log, TEXT("Trimmed %i m2u undo entries, m2u transactions now use %llu bytes"),
+				   NumRemove, (uint64)M2uBytes);
+		}
+		if( M2uBytes > MaxM2uBytes && NumRemove < Trimmable )
+		{
+			UE_LOG(LogM2U, Verbose, TEXT("m2u transactions use %llu bytes, older user entries keep the rest from being trimmed"),
+				   (uint64)M2uBytes);
+		}
+		return NumRemove;
+	}
+
+protected:
+
+	/** the number of BeginBatch commands not yet ended */
+	int32 BatchDepth;
+	/** if the outermost BeginBatch opened an editor transaction */
+	bool bBatchTransacting;
+	/** memory allowed for m2u transactions in Capped mode */
+	SIZE_T MaxBytes;
+	float TimeSinceTrim;
 };
@@ -12,7 +12,15 @@ class Fm2uOpVisibility : public Fm2uOperation
 public:
 
 Fm2uOpVisibility( Fm2uOperationManager* Manager = NULL )
-		:Fm2uOperation( Manager ){}
+		:Fm2uOperation( Manager ),
+		 bHiddenIndexValid( false ),
+		 bIsolated( false )
+	{}
+
+	~Fm2uOpVisibility()
+	{
+		SetIsolated( false );
+	}
 
 	bool Execute( FString Cmd, FString& Result ) override
 	{
@@ -35,7 +43,7 @@ Fm2uOpVisibility( Fm2uOperationManager* Manager = NULL )
 				// Don't consider already hidden actors or the builder brush
 				if( !FActorEditorUtils::IsABuilderBrush(Actor) && !Actor->IsHiddenEd() )
 				{
-					Actor->SetIsTemporarilyHiddenInEditor( true );
+					SetHidden( Actor, true );
 				}
 			}
 			GEditor->RedrawLevelEditingViewports();
@@ -54,7 +62,7 @@ Fm2uOpVisibility( Fm2uOperationManager* Manager = NULL )
 				// Don't consider already visible actors or the builder brush
 				if( !FActorEditorUtils::IsABuilderBrush(Actor) && Actor->IsHiddenEd() )
 				{
-					Actor->SetIsTemporarilyHiddenInEditor( false );
+					SetHidden( Actor, false );
 				}
 			}
 			GEditor->RedrawLevelEditingViewports();
@@ -62,46 +70,84 @@ Fm2uOpVisibility( Fm2uOperationManager* Manager = NULL )
 
 		else if( FParse::Command(&Str, TEXT("IsolateSelected")))
 		{
-			// Iterate through all of the actors and hide the ones which
-			// are not selected and are not already hidden
-			auto World = GEditor->GetEditorWorldContext().World();
-			for( FActorIterator It(World); It; ++It )
+			// When already isolated, only the Actors that were visible since
+			// then need to be checked. With Resync=True, or the first time,
+			// all Actors are checked, which also catches Actors unhidden in
+			// the Editor itself.
+			bool bResync = false;
+			FParse::Bool(Str, TEXT("Resync="), bResync);
+			TArray<AActor*> SelectedActors;
+			GEditor->GetSelectedActors()->GetSelectedObjects<AActor>(SelectedActors);
+			if( bIsolated && !bResync )
 			{
-				AActor* Actor = *It;
-				if( !FActorEditorUtils::IsABuilderBrush(Actor) && !Actor->IsSelected() && !Actor->IsHiddenEd() )
+				for( const TWeakObjectPtr<AActor>& Actor : IsolatedVisible )
 				{
-					Actor->SetIsTemporarilyHiddenInEditor( true );
+					if( Actor.IsValid() && !Actor->IsSelected() && !Actor->IsHiddenEd() )
+					{
+						SetHidden( Actor.Get(), true );
+					}
 				}
 			}
+			else
+			{
+				// hide all actors which are not selected and not already hidden
+				auto World = GEditor->GetEditorWorldContext().World();
+				for( FActorIterator It(World); It; ++It )
+				{
+					AActor* Actor = *It;
+					if( !FActorEditorUtils::IsABuilderBrush(Actor) && !Actor->IsSelected() && !Actor->IsHiddenEd() )
+					{
+						SetHidden( Actor, true );
+					}
+				}
+			}
+			IsolatedVisible.Empty();
+			for( AActor* Actor : SelectedActors )
+			{
+				IsolatedVisible.Add( Actor );
+			}
+			SetIsolated( true );
 			GEditor->RedrawLevelEditingViewports();
 		}
 
 		else if( FParse::Command(&Str, TEXT("UnhideAll")))
 		{
-			// Iterate through all of the actors and unhide them
-			auto World = GEditor->GetEditorWorldContext().World();
-			for( FActorIterator It(World); It; ++It )
+			// Only the Actors in the index are unhidden, the index is built
+			// on first use. Actors hidden in the Editor itself aren't in the
+			// index, pass Resync=True to rebuild it from all Actors first.
+			bool bResync = false;
+			FParse::Bool(Str, TEXT("Resync="), bResync);
+			if( bResync || !bHiddenIndexValid )
 			{
-				AActor* Actor = *It;
-				if( !FActorEditorUtils::IsABuilderBrush(Actor) && Actor->IsTemporarilyHiddenInEditor() )
+				ResyncHiddenActors();
+			}
+			for( const TWeakObjectPtr<AActor>& Actor : HiddenActors )
+			{
+				if( Actor.IsValid() )
 				{
 					Actor->SetIsTemporarilyHiddenInEditor( false );
 				}
 			}
+			HiddenActors.Empty();
+			IsolatedVisible.Empty();
+			SetIsolated( false );
 			GEditor->RedrawLevelEditingViewports();
 		}
 
+		else if( FParse::Command(&Str, TEXT("ResyncHiddenActors")))
+		{
+			ResyncHiddenActors();
+		}
+
 		else if( FParse::Command(&Str, TEXT("HideByNames")))
 		{
-			FString Name;
-			while( FParse::Token(Str, Name, 0) )
-			{
-				AActor* Actor = NULL;
-				if(m2uHelper::GetActorByName(*Name, &Actor) && !Actor->IsHiddenEd())
-				{
-					Actor->SetIsTemporarilyHiddenInEditor( true );
-				}
-			}
+			SetHiddenByNames( Str, true );
+			GEditor->RedrawLevelEditingViewports();
+		}
+
+		else if( FParse::Command(&Str, TEXT("UnhideByNames")))
+		{
+			SetHiddenByNames( Str, false );
 			GEditor->RedrawLevelEditingViewports();
 		}
 		
@@ -117,4 +163,177 @@ Fm2uOpVisibility( Fm2uOperationManager* Manager = NULL )
 		else
 			return false;
 	}
+
+	/**
+	   hide or unhide the Actor and keep track of it in the index of hidden Actors
+	*/
+	void SetHidden( AActor* Actor, bool bHidden )
+	{
+		Actor->SetIsTemporarilyHiddenInEditor( bHidden );
+		if( bHidden )
+		{
+			HiddenActors.Add( Actor );
+		}
+		else
+		{
+			HiddenActors.Remove( Actor );
+			if( bIsolated )
+				IsolatedVisible.Add( Actor );
+		}
+	}
+
+	/**
+	   start or end tracking the Actors that may be visible while isolated.
+	   New Actors are only watched while isolated. This is also why the
+	   delegate isn't bound in the constructor, the operations are created
+	   before GEngine exists.
+	*/
+	void SetIsolated( bool bInIsolated )
+	{
+		bIsolated = bInIsolated;
+		if( bIsolated && !ActorAddedHandle.IsValid() && GEngine != NULL )
+		{
+			ActorAddedHandle = GEngine->OnLevelActorAdded().AddRaw( this, &Fm2uOpVisibility::OnActorAdded );
+		}
+		else if( !bIsolated && ActorAddedHandle.IsValid() )
+		{
+			if( GEngine != NULL )
+			{
+				GEngine->OnLevelActorAdded().Remove( ActorAddedHandle );
+			}
+			ActorAddedHandle.Reset();
+		}
+	}
+
+	/** new Actors are visible, the next isolate has to know them */
+	void OnActorAdded( AActor* Actor )
+	{
+		if( bIsolated )
+		{
+			IsolatedVisible.Add( Actor );
+		}
+	}
+
+	/**
+	   hide or unhide all Actors listed in the string.
+	   The string is a whitespace separated list of names, handles ("#12") or
+	   wildcard patterns ("Debris_*", "Wall_??_LOD0"). Names in Maya can't
+	   contain '*' or '?', so every token containing those is taken as pattern.
+	   All patterns are tested in one pass over the Actors of the current level.
+	*/
+	void SetHiddenByNames( const TCHAR* Str, bool bHidden )
+	{
+		/** a pattern, "Prefix*" patterns are tested without wildcard matching */
+		struct FNameMatcher
+		{
+			FString Pattern;
+			bool bPrefixOnly;
+			bool Matches( const FString& Name ) const
+			{
+				return bPrefixOnly ? Name.StartsWith( Pattern ) : Name.MatchesWildcard( Pattern );
+			}
+		};
+		TArray<FNameMatcher> Matchers;
+
+		int32 NumChanged = 0;
+		FString Name;
+		while( FParse::Token(Str, Name, 0) )
+		{
+			int32 WildcardPos = INDEX_NONE;
+			Name.FindChar( TCHAR('*'), WildcardPos );
+			const bool bHasQuestionMark = Name.Contains( TEXT("?") );
+			if( WildcardPos != INDEX_NONE || bHasQuestionMark )
+			{
+				FNameMatcher& Matcher = Matchers[ Matchers.AddDefaulted() ];
+				Matcher.bPrefixOnly = !bHasQuestionMark && WildcardPos == Name.Len() - 1;
+				Matcher.Pattern = Matcher.bPrefixOnly ? Name.LeftChop(1) : Name;
+				continue;
+			}
+			AActor* Actor = NULL;
+			if( m2uHelper::GetActorByName(*Name, &Actor) && SetHiddenIfChanged( Actor, bHidden ) )
+			{
+				++NumChanged;
+			}
+		}
+
+		if( Matchers.Num() > 0 )
+		{
+			ULevel* Level = GEditor->GetEditorWorldContext().World()->GetCurrentLevel();
+			FString ActorName; // reused, to not allocate a string per Actor
+			for( AActor* Actor : Level->Actors )
+			{
+				if( Actor == NULL || FActorEditorUtils::IsABuilderBrush(Actor) )
+					continue;
+				Actor->GetFName().ToString( ActorName );
+				for( const FNameMatcher& Matcher : Matchers )
+				{
+					if( Matcher.Matches( ActorName ) )
+					{
+						if( SetHiddenIfChanged( Actor, bHidden ) )
+							++NumChanged;
+						break;
+					}
+				}
+			}
+		}
+		UE_LOG(LogM2U, Log, TEXT("%s %i Actors."), bHidden ? TEXT("Hid") : TEXT("Unhid"), NumChanged);
+	}
+
+	/**
+	   hide an Actor that is visible or unhide an Actor that was hidden.
+	   @return true if the Actor was changed
+	*/
+	bool SetHiddenIfChanged( AActor* Actor, bool bHidden )
+	{
+		if( bHidden && !Actor->IsHiddenEd() )
+		{
+			SetHidden( Actor, true );
+			return true;
+		}
+		if( !bHidden && Actor->IsTemporarilyHiddenInEditor() )
+		{
+			SetHidden( Actor, false );
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	   rebuild the index of hidden Actors from the Editor's state.
+	   This is necessary when Actors were hidden or unhidden in the Editor itself.
+	*/
+	void ResyncHiddenActors()
+	{
+		HiddenActors.Empty();
+		auto World = GEditor->GetEditorWorldContext().World();
+		for( FActorIterator It(World); It; ++It )
+		{
+			AActor* Actor = *It;
+			if( !FActorEditorUtils::IsABuilderBrush(Actor) && Actor->IsTemporarilyHiddenInEditor() )
+			{
+				HiddenActors.Add( Actor );
+			}
+		}
+		bHiddenIndexValid = true;
+	}
+
+protected:
+
+	/**
+	   the Actors that are (temporarily) hidden in the Editor.
+	   UnhideAll would otherwise have to check every Actor in the world, which
+	   takes long for big levels. The index is built from the Editor's state on
+	   first use, after that it is kept up to date by all m2u hide operations.
+	*/
+	TSet< TWeakObjectPtr<AActor> > HiddenActors;
+	bool bHiddenIndexValid;
+
+	/**
+	   after IsolateSelected, the Actors that may be visible: the isolated
+	   ones, Actors unhidden through m2u and new Actors. Isolating again only
+	   has to check these.
+	*/
+	TSet< TWeakObjectPtr<AActor> > IsolatedVisible;
+	bool bIsolated;
+	FDelegateHandle ActorAddedHandle;
 };
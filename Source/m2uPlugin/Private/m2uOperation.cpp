@@ -40,3 +40,43 @@ FString Fm2uOperationManager::Execute( FString Cmd )
 	UE_LOG(LogM2U, Warning, TEXT("Command not found: %s"), *Cmd);
 	return TEXT("Command Not Found");
 }
+
+void Fm2uOperationManager::Tick( float DeltaTime )
+{
+	for( Fm2uOperation* Operation : RegisteredOperations )
+	{
+		Operation -> Tick(DeltaTime);
+	}
+}
+
+bool Fm2uOperationManager::IsBusy() const
+{
+	for( const Fm2uOperation* Operation : RegisteredOperations )
+	{
+		if( Operation -> IsBusy() )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void Fm2uOperationManager::ClientDisconnected()
+{
+	for( Fm2uOperation* Operation : RegisteredOperations )
+	{
+		Operation -> OnClientDisconnected();
+	}
+}
+
+void Fm2uOperationManager::Push( const FString& Message )
+{
+	PendingPushMessages.Add( TEXT("Push ") + Message + TEXT("\n") );
+}
+
+TArray<FString> Fm2uOperationManager::TakePushMessages()
+{
+	TArray<FString> Messages;
+	Exchange( Messages, PendingPushMessages );
+	return Messages;
+}
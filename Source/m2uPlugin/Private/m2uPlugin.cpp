@@ -27,7 +27,12 @@ FString ExecuteCommand(const TCHAR* Str/*, Fm2uPlugin* Conn*/);
 
 Fm2uPlugin::Fm2uPlugin()
 	:Client(NULL),
-	 TcpListener(NULL)
+	 TcpListener(NULL),
+	 PushClient(NULL),
+	 PushListener(NULL),
+	 TickObject(NULL),
+	 OperationManager(NULL),
+	 BatchFileParser(NULL)
 {
 }
 
@@ -40,12 +45,21 @@ void Fm2uPlugin::StartupModule()
 		return;
 	}
 
+	OperationManager = new Fm2uOperationManager();
+	CreateBuiltinOperations(OperationManager);
+
+	BatchFileParser = new Fm2uBatchFileParser(OperationManager);
+
+	// a commandlet drives the operations itself, there is no UI and nobody
+	// to connect
+	if( IsRunningCommandlet() )
+	{
+		return;
+	}
+
 	ResetConnection( DEFAULT_M2U_PORT );
 
 	TickObject = new Fm2uTickObject(this);
-	
-	OperationManager = new Fm2uOperationManager();
-	CreateBuiltinOperations(OperationManager);
 
 	m2uUI::RegisterUI();
 }
@@ -60,18 +74,53 @@ void Fm2uPlugin::ShutdownModule()
 		Client->Close();
 		Client=NULL;
 	}
+	if( PushClient != NULL )
+	{
+		PushClient->Close();
+		PushClient = NULL;
+	}
 
-	TcpListener->Stop();
-	delete TcpListener;
-	TcpListener = NULL;
+	if( TcpListener != NULL )
+	{
+		TcpListener->Stop();
+		delete TcpListener;
+		TcpListener = NULL;
+	}
+	if( PushListener != NULL )
+	{
+		PushListener->Stop();
+		delete PushListener;
+		PushListener = NULL;
+	}
 
 	delete TickObject;
 	TickObject = NULL;
 
+	delete BatchFileParser;
+	BatchFileParser = NULL;
+
 	delete OperationManager;
 	OperationManager = NULL;
 
-	m2uUI::UnregisterUI();
+	if( !IsRunningCommandlet() )
+	{
+		m2uUI::UnregisterUI();
+	}
+}
+
+FString Fm2uPlugin::ExecuteCommand( const FString& Cmd )
+{
+	return OperationManager->Execute(Cmd);
+}
+
+bool Fm2uPlugin::StartBatchFile( const FString& Filename, double Budget )
+{
+	return BatchFileParser->Start(Filename, Budget);
+}
+
+bool Fm2uPlugin::IsBusy()
+{
+	return BatchFileParser->IsRunning() || OperationManager->IsBusy();
 }
 
 bool Fm2uPlugin::Exec( UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar )
@@ -87,15 +136,29 @@ bool Fm2uPlugin::Exec( UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar )
 		ResetConnection(Port);
 		return true;
 	}
+	// m2uBatchFileParse <Filename> [BudgetMs=10]
+	// execute the commands in the file, spending at most BudgetMs every tick
 	else if( FParse::Command(&Cmd, TEXT("m2uBatchFileParse")) )
 	{
 		FString Filename;
 		if( FParse::Token(Cmd, Filename, 0))
 		{
-			m2uBatchFileParse(Filename);
+			float BudgetMs = 10.0f;
+			FParse::Value(Cmd, TEXT("BudgetMs="), BudgetMs);
+			BatchFileParser->Start(Filename, BudgetMs / 1000.0);
 		}
 		return true;
 	}
+	else if( FParse::Command(&Cmd, TEXT("m2uBatchFileCancel")) )
+	{
+		BatchFileParser->Cancel();
+		return true;
+	}
+	else if( FParse::Command(&Cmd, TEXT("m2uBatchFileStatus")) )
+	{
+		Ar.Log(BatchFileParser->GetStatus());
+		return true;
+	}
 	else if( FParse::Command(&Cmd, TEXT("m2uDo")) )
 	{
 		// execute an Action without using tcp connection
@@ -112,15 +175,31 @@ void Fm2uPlugin::ResetConnection(uint16 Port)
 	{
 		Client->Close();
 		Client=NULL;
+		OperationManager->ClientDisconnected();
+	}
+	if( PushClient != NULL )
+	{
+		PushClient->Close();
+		PushClient = NULL;
 	}
 	if(TcpListener != NULL)
 	{
 		TcpListener->Stop();
 		delete TcpListener;
 	}
-	UE_LOG(LogM2U, Log, TEXT("Hosting on Port %i"), Port);
+	if( PushListener != NULL )
+	{
+		PushListener->Stop();
+		delete PushListener;
+	}
+	const uint16 PushPort = Port + M2U_PUSH_PORT_OFFSET;
+	UE_LOG(LogM2U, Log, TEXT("Hosting on Port %i, pushing on Port %i"), Port, PushPort);
 	TcpListener = new FTcpListener( FIPv4Endpoint(DEFAULT_M2U_ADDRESS, Port) );
 	TcpListener->OnConnectionAccepted().BindRaw(this, &Fm2uPlugin::HandleConnectionAccepted);
+	// pushes get their own connection, so they can never end up between a
+	// command and its response
+	PushListener = new FTcpListener( FIPv4Endpoint(DEFAULT_M2U_ADDRESS, PushPort) );
+	PushListener->OnConnectionAccepted().BindRaw(this, &Fm2uPlugin::HandlePushConnectionAccepted);
 }
 
 bool Fm2uPlugin::HandleConnectionAccepted( FSocket* ClientSocket, const FIPv4Endpoint& ClientEndpoint)
@@ -137,9 +216,25 @@ bool Fm2uPlugin::HandleConnectionAccepted( FSocket* ClientSocket, const FIPv4End
 	return false;
 }
 
+bool Fm2uPlugin::HandlePushConnectionAccepted( FSocket* ClientSocket, const FIPv4Endpoint& ClientEndpoint)
+{
+	if( PushClient == NULL )
+	{
+		PushClient = ClientSocket;
+		UE_LOG(LogM2U, Log, TEXT("Push connection on Port %i."), PushClient->GetPortNo());
+		return true;
+	}
+	UE_LOG(LogM2U, Log, TEXT("Push connection declined"));
+	return false;
+}
 
-void Fm2uPlugin::Tick( float DeltaTime )
+
+bool Fm2uPlugin::Tick( float DeltaTime )
 {
+	bool bHandledMessage = false;
+	OperationManager->Tick(DeltaTime);
+	BatchFileParser->Tick(DeltaTime);
+
 	// valid and connected?
 	if( Client != NULL && Client -> GetConnectionState() == SCS_Connected)
 	{
@@ -153,8 +248,33 @@ void Fm2uPlugin::Tick( float DeltaTime )
 			// operations in one go
 			FString Result = OperationManager->Execute(Message);
 			SendResponse(Result);
+			bHandledMessage = true;
 		}
 	}
+	else if( Client != NULL )
+	{
+		// the Program went away, make room for the next one and don't leave
+		// anything it started open
+		UE_LOG(LogM2U, Log, TEXT("Client disconnected"));
+		Client->Close();
+		Client = NULL;
+		OperationManager->ClientDisconnected();
+	}
+
+	if( PushClient != NULL && PushClient -> GetConnectionState() != SCS_Connected )
+	{
+		UE_LOG(LogM2U, Log, TEXT("Push client disconnected"));
+		PushClient->Close();
+		PushClient = NULL;
+	}
+
+	// send what the Program subscribed to, if it listens for it. If nobody
+	// does, don't let the messages pile up.
+	for( const FString& Push : OperationManager->TakePushMessages() )
+	{
+		SendPush(Push);
+	}
+	return bHandledMessage;
 }
 
 
@@ -206,7 +326,17 @@ bool Fm2uPlugin::GetMessage(FString& Result)
 
 void Fm2uPlugin::SendResponse(const FString& Message)
 {
-	if( Client != NULL && Client -> GetConnectionState() == SCS_Connected)
+	SendTo(Client, Message);
+}
+
+void Fm2uPlugin::SendPush( const FString& Message )
+{
+	SendTo(PushClient, Message);
+}
+
+void Fm2uPlugin::SendTo( FSocket* Socket, const FString& Message )
+{
+	if( Socket != NULL && Socket -> GetConnectionState() == SCS_Connected)
 	{
 		//const uint8* Data = *Message;
 		//const int32 Count = Message.Len();
@@ -217,7 +347,7 @@ void Fm2uPlugin::SendResponse(const FString& Message)
 		Dest[DestLen]='\0';
 
 		int32 BytesSent = 0;
-		if(	! Client->Send( Dest, DestLen, BytesSent) )
+		if(	! Socket->Send( Dest, DestLen, BytesSent) )
 		{
 			UE_LOG(LogM2U, Error, TEXT("TCP Server sending answer failed."));
 		}
@@ -9,6 +9,8 @@ class Fm2uTickObject;
 //#define DEFAULT_M2U_ENDPOINT FIPv4Endpoint(FIPv4Address(0,0,0,0), 3939)
 #define DEFAULT_M2U_ADDRESS FIPv4Address(0,0,0,0)
 #define DEFAULT_M2U_PORT 3939
+// pushed messages go over their own connection on the command port + this
+#define M2U_PUSH_PORT_OFFSET 1
 
 class Fm2uPlugin : public Im2uPlugin, private FSelfRegisteringExec
 {
@@ -26,23 +28,37 @@ public:
 
 	/* TcpListener Delegate */
 	bool HandleConnectionAccepted( FSocket* ClientSocket, const struct FIPv4Endpoint& ClientEndpoint);
+	bool HandlePushConnectionAccepted( FSocket* ClientSocket, const struct FIPv4Endpoint& ClientEndpoint);
 
-	/* TickObject Delegate */
-	void Tick( float DeltaTime );
+	/* TickObject Delegate, returns if a message of the Program was handled */
+	bool Tick( float DeltaTime );
 
 	/* TCP messaging functions */
 	bool GetMessage(FString& Result);
 	void SendResponse( const FString& Message);
+	void SendPush( const FString& Message );
 	void ResetConnection(uint16 Port);
 
+	/* Interface for headless runs (see Um2uCommandlet) */
+	FString ExecuteCommand( const FString& Cmd );
+	bool StartBatchFile( const FString& Filename, double Budget );
+	/** if a batch file or an Operation (like a scene package) is still being executed */
+	bool IsBusy();
+
 	/* FExec implementation */
 	virtual bool Exec( UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar );
 
 protected:
+	static void SendTo( FSocket* Socket, const FString& Message );
+
 	FSocket* Client;
 	class FTcpListener* TcpListener;
+	/** the Program's connection for messages it didn't ask for */
+	FSocket* PushClient;
+	class FTcpListener* PushListener;
 	Fm2uTickObject* TickObject;
 	class Fm2uOperationManager* OperationManager;
+	class Fm2uBatchFileParser* BatchFileParser;
 
 };
 
@@ -0,0 +1,119 @@
+#ifndef _M2UPROPERTYHELPER_H_
+#define _M2UPROPERTYHELPER_H_
+
+// This file contains functions to find and access properties of Actors and
+// their components by name, using the reflection system.
+// A property is addressed by a Target string "[Component:]Property.Member"
+// where the optional Component is the name (or class name) of one of the Actor's
+// components, and the property path may go down into struct members, like
+// "RelativeLocation.X".
+
+namespace m2uPropertyHelper
+{
+
+/**
+   The chain of properties from the object down to the addressed value.
+   The last element is the property of the value itself.
+ */
+	typedef TArray<UProperty*> FPropertyChain;
+
+
+/**
+   Split a Target string into the component and the property path parts.
+ */
+	void SplitTarget(const FString& Target, FString& OutComponent, FString& OutPath)
+	{
+		if( !Target.Split(TEXT(":"), &OutComponent, &OutPath) )
+		{
+			OutComponent.Empty();
+			OutPath = Target;
+		}
+	}
+
+
+/**
+   Find the object a Target refers to, the Actor itself if no component is
+   specified, or the Actor's component with that name or of that class.
+   @return NULL if there is no such component
+ */
+	UObject* FindTargetObject(AActor* Actor, const FString& ComponentName)
+	{
+		if( ComponentName.IsEmpty() )
+		{
+			return Actor;
+		}
+		TInlineComponentArray<UActorComponent*> Components;
+		Actor->GetComponents(Components);
+		for( UActorComponent* Component : Components )
+		{
+			if( Component->GetName() == ComponentName )
+				return Component;
+		}
+		for( UActorComponent* Component : Components )
+		{
+			if( Component->GetClass()->GetName() == ComponentName )
+				return Component;
+		}
+		return NULL;
+	}
+
+
+/**
+   Resolve the property path on the given class.
+   Resolving means one FindField per path element, and this happens for every
+   Actor of the same class with the same path over and over, so the results
+   (also the failed ones) are cached per class.
+   The chains are shared refs, so the returned pointer stays valid when the
+   cache grows, callers may keep it.
+
+   @return the chain of properties, or NULL if the path does not exist
+ */
+	const FPropertyChain* ResolvePropertyPath(UStruct* Class, const FString& Path)
+	{
+		// weak keys, a class that was garbage collected (e.g. a recompiled
+		// Blueprint) won't match a new class at the same address
+		static TMap< TWeakObjectPtr<UStruct>, TMap<FString, TSharedRef<FPropertyChain> > > Cache;
+
+		TMap<FString, TSharedRef<FPropertyChain> >& ClassCache = Cache.FindOrAdd(Class);
+		const TSharedRef<FPropertyChain>* Cached = ClassCache.Find(Path);
+		if( Cached == NULL )
+		{
+			FPropertyChain Chain;
+			TArray<FString> Elements;
+			Path.ParseIntoArray(Elements, TEXT("."), true);
+			UStruct* Struct = Class;
+			for( int32 Idx = 0; Idx < Elements.Num(); ++Idx )
+			{
+				UProperty* Property = (Struct != NULL) ?
+					FindField<UProperty>(Struct, FName(*Elements[Idx])) : NULL;
+				if( Property == NULL )
+				{
+					Chain.Empty();
+					break;
+				}
+				Chain.Add(Property);
+				UStructProperty* StructProperty = Cast<UStructProperty>(Property);
+				Struct = (StructProperty != NULL) ? StructProperty->Struct : NULL;
+			}
+			Cached = &ClassCache.Add(Path, MakeShareable(new FPropertyChain(Chain)));
+		}
+		const FPropertyChain& Result = Cached->Get();
+		return (Result.Num() > 0) ? &Result : NULL;
+	}
+
+
+/**
+   Get the address of the value the Chain addresses in the Object.
+ */
+	void* GetValuePtr(const FPropertyChain& Chain, UObject* Object)
+	{
+		void* Ptr = Object;
+		for( UProperty* Property : Chain )
+		{
+			Ptr = Property->ContainerPtrToValuePtr<void>(Ptr);
+		}
+		return Ptr;
+	}
+
+} // namespace m2uPropertyHelper
+#endif /* _M2UPROPERTYHELPER_H_ */
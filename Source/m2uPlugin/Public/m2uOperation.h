@@ -19,6 +19,21 @@ public:
 	 * Try to execute the command. Return false early if not able to execute.
 	 */
 	virtual bool Execute( FString Cmd, FString& Result ) = 0;
+
+	/**
+	 * Called once per frame, for Operations that have to do work independent
+	 * of incoming commands. */
+	virtual void Tick( float DeltaTime ){}
+
+	/**
+	 * If the Operation still has work to do in coming ticks, like loading
+	 * something in the background. */
+	virtual bool IsBusy() const { return false; }
+
+	/**
+	 * Called when the Program disconnected or its connection was reset, for
+	 * Operations that keep state for the Program between commands. */
+	virtual void OnClientDisconnected(){}
 };
 
 
@@ -34,6 +49,8 @@ protected:
 
 	TArray<Fm2uOperation*> RegisteredOperations;
 
+	TArray<FString> PendingPushMessages;
+
 public:
 
 	~Fm2uOperationManager();
@@ -45,6 +62,30 @@ public:
 	/**
 	 * let the first able of the registered Operations handle the Cmd string */
 	FString Execute( FString Cmd );
+
+	/**
+	 * tick all registered Operations */
+	void Tick( float DeltaTime );
+
+	/**
+	 * if any of the registered Operations is still busy */
+	bool IsBusy() const;
+
+	/**
+	 * tell all registered Operations that the Program is gone */
+	void ClientDisconnected();
+
+	/**
+	 * queue a message that is sent to the Program without it asking for it.
+	 * Pushed messages go over the separate push connection (command port + 1),
+	 * never the command connection. They start with "Push " and end with a
+	 * newline. They are only sent for things the Program subscribed to, and
+	 * dropped if the Program has no push connection. */
+	void Push( const FString& Message );
+
+	/**
+	 * take all queued push messages */
+	TArray<FString> TakePushMessages();
 };
 
 // TODO: i want the operations to be able to internally ask for further input